@@ -0,0 +1,566 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <list>
+#include <chrono>
+#include <functional>
+#include <cstdlib>
+#include <type_traits>
+#include <algorithm>
+#include <memory>
+
+#include "../XorList/StackAllocator.h"
+#include "../XorList/BlockReclaimer.h"
+#include "../XorList/StackMemoryResource.h"
+#include "../XorList/XorList.h"
+#include "../XorList/ListOperation.h"
+#include "../XorList/OperationTrace.h"
+#include "BenchmarkStats.h"
+#include "BenchmarkReport.h"
+#include "LatencyHistogram.h"
+#include "PerfCounters.h"
+#include "MemoryFootprint.h"
+#include "ElementTypes.h"
+
+//usage: Benchmark [--format csv|json] [--output file] [--warmup N] [--repetitions N]
+//                 [--max-operations N] [--outlier-cutoff X] [--latency-output file] [--latency-runs N]
+//                 [--memory-output file] [--memory-elements N] [--trace file] [--trace-dir dir] [--seed N]
+//                 [--profile-elements N] [--profile-operations N] [--lru-max-rank N] [--sweep-operations N]
+//                 [--teardown-output file] [--teardown-arenas N] [--teardown-elements N]
+struct BenchmarkConfig {
+	std::string format = "csv";
+	std::string output; //standard output if empty
+	size_t warmup = 2;
+	size_t repetitions = 15;
+	size_t maxOperations = 1000000;
+	double outlierCutoff = 3.5;
+	//per-operation latencies are only recorded, in runs of their own, if set
+	std::string latencyOutput;
+	size_t latencyRuns = 1;
+	//bytes per element are only measured if set
+	std::string memoryOutput;
+	size_t memoryElements = 1000000;
+	//replays this operation trace instead of the generated sequences
+	std::string trace;
+	//keeps the generated sequences as traces here, and replays the ones already kept
+	std::string traceDir;
+	//of the generated sequences, fixed so that runs of different builds compare the same operations
+	uint64_t seed = 1;
+	//the workload profiles only run if set, on lists filled with this many elements (up to 10^8)
+	size_t profileElements = 0;
+	size_t profileOperations = 100000;
+	//deepest position an LRU hit walks to, see WorkloadParameters::lruMaxRank
+	size_t lruMaxRank = WorkloadParameters().lruMaxRank;
+	//every element type of forEachElement is timed on the generated sequence of this many operations, if not 0
+	size_t sweepOperations = 1000000;
+	//how long destroying an arena list takes, in place and with a BlockReclaimer, is only measured if set
+	std::string teardownOutput;
+	size_t teardownArenas = 1000;
+	size_t teardownElements = 300000;
+};
+
+typedef ListOperation <int> Operation;
+typedef OperationTrace <int> Operations;
+
+//operations timed on lists filled with fill elements first
+struct Workload {
+	std::string name;
+	const Operations &ops;
+	size_t numOfOps;
+	size_t fill;
+};
+
+//calls visit(name, run) for every compared container, where run(apply) builds
+//an empty list of T of that kind and returns apply(list)
+template <class T, class Visitor>
+void forEachContainer(Visitor visit) {
+	visit("std::list<std::allocator>", [](auto apply) {
+		std::list<T> list;
+		return apply(list);
+	});
+	visit("std::list<StackAlloc>", [](auto apply) {
+		std::list<T, StackAllocator<T> > list{ StackAllocator<T>() };
+		return apply(list);
+	});
+	visit("XorList<std::allocator>", [](auto apply) {
+		XorList<T> list;
+		return apply(list);
+	});
+	visit("XorList<StackAlloc>", [](auto apply) {
+		XorList<T, StackAllocator<T> > list{ StackAllocator<T>() };
+		return apply(list);
+	});
+	visit("pmr::XorList<StackResource>", [](auto apply) {
+		StackMemoryResource resource;
+		pmr::XorList<T> list(&resource);
+		return apply(list);
+	});
+}
+
+//like forEachContainer, for lists of T whose memory is counted: run(heap, requested, apply)
+//builds an empty list whose allocations, and the arena blocks behind them, are counted in heap;
+//requested counts what the list asked its arena for, and stays empty for the other lists
+template <class T, class Visitor>
+void forEachCountedContainer(Visitor visit) {
+	visit("std::list<std::allocator>", [](MemoryCounter &heap, MemoryCounter &, auto apply) {
+		std::list<T, CountingAllocator<T> > list{ CountingAllocator<T>(std::allocator<T>(), heap) };
+		return apply(list);
+	});
+	visit("std::list<StackAlloc>", [](MemoryCounter &heap, MemoryCounter &requested, auto apply) {
+		CountingBlockSource source(heap);
+		typedef CountingAllocator<T, StackAllocator<T> > Alloc;
+		std::list<T, Alloc> list{ Alloc(StackAllocator<T>(source), requested) };
+		return apply(list);
+	});
+	visit("XorList<std::allocator>", [](MemoryCounter &heap, MemoryCounter &, auto apply) {
+		XorList<T, CountingAllocator<T> > list{ CountingAllocator<T>(std::allocator<T>(), heap) };
+		return apply(list);
+	});
+	visit("XorList<StackAlloc>", [](MemoryCounter &heap, MemoryCounter &requested, auto apply) {
+		CountingBlockSource source(heap);
+		typedef CountingAllocator<T, StackAllocator<T> > Alloc;
+		XorList<T, Alloc> list{ Alloc(StackAllocator<T>(source), requested) };
+		return apply(list);
+	});
+	visit("pmr::XorList<StackResource>", [](MemoryCounter &heap, MemoryCounter &, auto apply) {
+		CountingBlockSource source(heap);
+		StackMemoryResource resource(source);
+		pmr::XorList<T> list(&resource);
+		return apply(list);
+	});
+}
+
+//pushes back count elements, outside of any timing
+template <class Element, class List>
+void fillList(List &list, size_t count) {
+	for (size_t i = 0; i < count; i++)
+		list.push_back(Element::make(int(i)));
+}
+
+//seconds spent in ops alone: the list is built before the clock starts and destroyed after it stops.
+//Every operation acts on the list of Element::type as ListOperation::apply does
+template <class Element, class List>
+double runOperations(List &list, const Operations &ops) {
+	ListCursor<List> cursor;
+	auto begTime = std::chrono::steady_clock::now();
+	for (const auto &op : ops)
+		op.template apply<Element>(list, cursor);
+	auto endTime = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(endTime - begTime).count();
+}
+
+//times every operation on its own, into the histogram of its kind
+template <class Element, class List>
+int recordLatencies(List &list, const Operations &ops, std::vector<LatencyHistogram> &histograms) {
+	ListCursor<List> cursor;
+	for (const auto &op : ops) {
+		auto begTime = std::chrono::steady_clock::now();
+		op.template apply<Element>(list, cursor);
+		auto endTime = std::chrono::steady_clock::now();
+		histograms[op.kind()].record(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - begTime).count());
+	}
+	return 0;
+}
+
+//one more run with the hardware counters on, reported per operation
+template <class Element, class List>
+int addCounters(List &list, const Operations &ops, size_t numOfOps, PerfCounters &counters, BenchmarkReport &report) {
+	ListCursor<List> cursor;
+	counters.start();
+	for (const auto &op : ops)
+		op.template apply<Element>(list, cursor);
+	counters.stop();
+	for (size_t i = 0; i < PerfCounters::EVENT_COUNT; i++) {
+		PerfCounters::Event event = PerfCounters::Event(i);
+		if (counters.available(event))
+			report.add(std::string(PerfCounters::eventName(event)) + "_per_op", double(counters.value(event)) / numOfOps);
+	}
+	return 0;
+}
+
+//median cost of reading the clock twice, included in every recorded latency
+double timerOverheadNs() {
+	std::vector<double> samples;
+	for (size_t i = 0; i < 1001; i++) {
+		auto begTime = std::chrono::steady_clock::now();
+		auto endTime = std::chrono::steady_clock::now();
+		samples.push_back(std::chrono::duration<double, std::nano>(endTime - begTime).count());
+	}
+	return summarize(samples).median;
+}
+
+//warm-up runs are thrown away, every repetition starts from an empty list
+std::vector<double> measure(const BenchmarkConfig &config, const std::function<double()> &run) {
+	for (size_t i = 0; i < config.warmup; i++)
+		run();
+	std::vector<double> samples;
+	for (size_t i = 0; i < config.repetitions; i++)
+		samples.push_back(run());
+	return samples;
+}
+
+#ifdef XORLIST_ARENA_STATS
+//one more, untimed run, as the counters would slow the timed ones down
+template <class Element, class List>
+int addArenaStats(List &list, const Operations &ops, BenchmarkReport &report) {
+	typedef typename Element::type T;
+	if constexpr (std::is_same<decltype(list.get_allocator()), StackAllocator<T> >::value) {
+		ListCursor<List> cursor;
+		for (const auto &op : ops)
+			op.template apply<Element>(list, cursor);
+		const ArenaStats &stats = list.get_allocator().stats();
+		report.add("bytes_requested", stats.bytesRequested);
+		report.add("bytes_handed_out", stats.bytesHandedOut);
+		report.add("bytes_wasted", stats.bytesWasted);
+		report.add("peak_blocks", stats.peakBlocks);
+	}
+	return 0;
+}
+#endif
+
+//the seed the operations were generated from, empty for a replayed --trace
+std::string workloadSeed(const BenchmarkConfig &config) {
+	return config.trace.empty() ? std::to_string(config.seed) : std::string();
+}
+
+template <class Element>
+void addRow(BenchmarkReport &report, const BenchmarkConfig &config, const std::string &name,
+	const Workload &workload, const std::vector<double> &samples) {
+	SampleStats stats = summarize(samples, config.outlierCutoff);
+	size_t numOfOps = workload.numOfOps;
+	report.beginRow();
+	report.add("list", name);
+	report.add("element", Element::name());
+	report.add("element_size", sizeof(typename Element::type));
+	report.add("workload", workload.name);
+	report.add("elements", workload.fill);
+	report.add("operations", numOfOps);
+	report.add("seed", workloadSeed(config));
+	report.add("repetitions", stats.count);
+	report.add("rejected", stats.rejected);
+	report.add("median_s", stats.median);
+	report.add("mad_s", stats.mad);
+	report.add("p99_s", stats.p99);
+	report.add("mean_s", stats.mean);
+	report.add("min_s", stats.min);
+	report.add("max_s", stats.max);
+	report.add("median_ns_per_op", stats.median * 1e9 / numOfOps);
+}
+
+template <class Element>
+void addLatencyRows(BenchmarkReport &report, const BenchmarkConfig &config, const std::string &name,
+	const Workload &workload, const std::vector<LatencyHistogram> &histograms, double timerOverhead) {
+	for (size_t kind = 0; kind < Operation::KIND_COUNT; kind++) {
+		const LatencyHistogram &histogram = histograms[kind];
+		if (histogram.count() == 0)
+			continue;
+		report.beginRow();
+		report.add("list", name);
+		report.add("element", Element::name());
+		report.add("workload", workload.name);
+		report.add("elements", workload.fill);
+		report.add("operations", workload.numOfOps);
+		report.add("seed", workloadSeed(config));
+		report.add("kind", Operation::kindName(Operation::Kind(kind)));
+		report.add("count", size_t(histogram.count()));
+		report.add("p50_ns", size_t(histogram.percentile(0.5)));
+		report.add("p99_ns", size_t(histogram.percentile(0.99)));
+		report.add("p99.9_ns", size_t(histogram.percentile(0.999)));
+		report.add("max_ns", size_t(histogram.max()));
+		report.add("timer_overhead_ns", timerOverhead);
+	}
+}
+
+template <class Element = IntElement>
+void compareWorkingTime(const BenchmarkConfig &config, const Workload &workload, BenchmarkReport &report,
+	BenchmarkReport &latencyReport, PerfCounters &counters, double timerOverhead) {
+	const Operations &ops = workload.ops;
+	forEachContainer<typename Element::type>([&](const std::string &name, auto run) {
+		addRow<Element>(report, config, name, workload, measure(config, [&]() {
+			return run([&](auto &list) {
+				fillList<Element>(list, workload.fill);
+				return runOperations<Element>(list, ops);
+			});
+		}));
+		if (counters.anyAvailable())
+			run([&](auto &list) {
+				fillList<Element>(list, workload.fill);
+				return addCounters<Element>(list, ops, workload.numOfOps, counters, report);
+			});
+#ifdef XORLIST_ARENA_STATS
+		run([&](auto &list) {
+			fillList<Element>(list, workload.fill);
+			return addArenaStats<Element>(list, ops, report);
+		});
+#endif
+		if (config.latencyOutput.empty())
+			return;
+		std::vector<LatencyHistogram> histograms(Operation::KIND_COUNT);
+		for (size_t i = 0; i < config.latencyRuns; i++)
+			run([&](auto &list) {
+				fillList<Element>(list, workload.fill);
+				return recordLatencies<Element>(list, ops, histograms);
+			});
+		addLatencyRows<Element>(latencyReport, config, name, workload, histograms, timerOverhead);
+	});
+}
+
+//bytes per element of lists of count push_back'ed Element::make(i): as allocated through the counted
+//allocator (or taken in arena blocks), left unused in the arena blocks, and as grown resident set.
+//The allocator only sees the nodes, so what an element allocates itself (a long string, the int of
+//a unique_ptr) shows in the resident set alone
+template <class Element>
+void addMemoryRows(BenchmarkReport &report, size_t count) {
+	typedef typename Element::type T;
+	forEachCountedContainer<T>([&](const std::string &name, auto run) {
+		MemoryCounter heap, requested;
+		size_t resident = 0;
+		releaseFreeMemory();
+		run(heap, requested, [&](auto &list) {
+			size_t residentBefore = residentBytes();
+			for (size_t i = 0; i < count; i++)
+				list.push_back(Element::make(int(i)));
+			resident = residentBytes() - residentBefore;
+			return 0;
+		});
+		report.beginRow();
+		report.add("list", name);
+		report.add("element", Element::name());
+		report.add("element_size", sizeof(T));
+		report.add("elements", count);
+		report.add("heap_bytes_per_element", double(heap.peak) / count);
+		if (requested.peak != 0)
+			report.add("arena_waste_bytes_per_element", double(heap.peak - requested.peak) / count);
+		if (resident != 0)
+			report.add("rss_bytes_per_element", double(resident) / count);
+	});
+}
+
+void compareMemory(const BenchmarkConfig &config, BenchmarkReport &report) {
+	forEachElement([&](auto tag) {
+		addMemoryRows<typename decltype(tag)::type>(report, config.memoryElements);
+	});
+}
+
+//a list and the only allocator left of its arena, so that destroying it destroys the arena too
+struct ArenaList {
+	StackAllocator<int> alloc;
+	XorList<int, StackAllocator<int> > list;
+
+	explicit ArenaList(BlockSource &source) : alloc(source), list(alloc) {
+		//initialize values
+	}
+};
+
+//wall-clock microseconds the destroying thread spends in ~XorList and the arena, one sample per
+//arena after the warm-up ones
+std::vector<double> teardownLatencies(const BenchmarkConfig &config, BlockReclaimer *reclaimer) {
+	MmapBlockSource source;
+	std::vector<double> samples;
+	for (size_t i = 0; i < config.warmup + config.teardownArenas; i++) {
+		auto list = std::make_unique<ArenaList>(source);
+		if (reclaimer != nullptr)
+			list->alloc.setReclaimer(*reclaimer);
+		for (size_t j = 0; j < config.teardownElements; j++)
+			list->list.push_back(int(j));
+		auto begTime = std::chrono::steady_clock::now();
+		list.reset();
+		auto endTime = std::chrono::steady_clock::now();
+		if (i >= config.warmup)
+			samples.push_back(std::chrono::duration<double, std::micro>(endTime - begTime).count());
+	}
+	if (reclaimer != nullptr)
+		reclaimer->drain(); //before source is destroyed
+	return samples;
+}
+
+void compareTeardown(const BenchmarkConfig &config, BenchmarkReport &report) {
+	BlockReclaimer reclaimer;
+	for (BlockReclaimer *r : { (BlockReclaimer*)nullptr, &reclaimer }) {
+		SampleStats stats = summarize(teardownLatencies(config, r), config.outlierCutoff);
+		report.beginRow();
+		report.add("teardown", r == nullptr ? "in_place" : "block_reclaimer");
+		report.add("elements", config.teardownElements);
+		report.add("arenas", stats.count);
+		report.add("median_us", stats.median);
+		report.add("mad_us", stats.mad);
+		report.add("p99_us", stats.p99);
+		report.add("max_us", stats.max);
+	}
+}
+
+//streams every chunk straight into a trace of its own, so that no list of all the operations is ever built
+std::string encodeStaticOperations(size_t numOfOps, uint64_t seed) {
+	std::vector<std::string> chunks = generateChunks<std::string, int>(randomStaticPhases<int>(numOfOps), seed,
+		[](OperationStream<int> &stream) {
+			std::ostringstream chunk;
+			OperationTraceWriter<int>(chunk).writeAll(stream);
+			return chunk.str().substr(OperationTraceFormat::HEADER_SIZE);
+		});
+	std::ostringstream out;
+	{
+		OperationTraceWriter<int> header(out);
+	}
+	for (const std::string &chunk : chunks)
+		out << chunk;
+	return out.str();
+}
+
+//the operations of profile after its fill, which the timed runs do with fillList instead
+std::string encodeProfileOperations(const BenchmarkConfig &config, WorkloadProfile profile) {
+	OperationRandom random(config.seed);
+	WorkloadParameters parameters;
+	parameters.profile = profile;
+	parameters.size = config.profileElements;
+	parameters.lruMaxRank = config.lruMaxRank;
+	ProfileStream<int> stream(parameters, config.profileOperations, random);
+	stream.skipFill();
+	std::ostringstream out;
+	OperationTraceWriter<int>(out).writeAll(stream);
+	return out.str();
+}
+
+void writeReport(const BenchmarkConfig &config, const BenchmarkReport &report, const std::string &path) {
+	std::ofstream file;
+	if (!path.empty())
+		file.open(path);
+	std::ostream &out = path.empty() ? std::cout : file;
+	if (config.format == "json")
+		report.writeJson(out);
+	else
+		report.writeCsv(out);
+}
+
+bool parseArguments(int argc, char **argv, BenchmarkConfig &config) {
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string name = argv[i], value = argv[i + 1];
+		if (name == "--format" && (value == "csv" || value == "json"))
+			config.format = value;
+		else if (name == "--output")
+			config.output = value;
+		else if (name == "--warmup")
+			config.warmup = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "--repetitions")
+			config.repetitions = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "--max-operations")
+			config.maxOperations = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "--outlier-cutoff")
+			config.outlierCutoff = std::strtod(value.c_str(), nullptr);
+		else if (name == "--latency-output")
+			config.latencyOutput = value;
+		else if (name == "--latency-runs")
+			config.latencyRuns = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "--memory-output")
+			config.memoryOutput = value;
+		else if (name == "--memory-elements")
+			config.memoryElements = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "--trace")
+			config.trace = value;
+		else if (name == "--trace-dir")
+			config.traceDir = value;
+		else if (name == "--seed")
+			config.seed = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "--profile-elements")
+			config.profileElements = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "--profile-operations")
+			config.profileOperations = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "--lru-max-rank")
+			config.lruMaxRank = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "--sweep-operations")
+			config.sweepOperations = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "--teardown-output")
+			config.teardownOutput = value;
+		else if (name == "--teardown-arenas")
+			config.teardownArenas = std::strtoull(value.c_str(), nullptr, 10);
+		else if (name == "--teardown-elements")
+			config.teardownElements = std::strtoull(value.c_str(), nullptr, 10);
+		else
+			return false;
+	}
+	return argc % 2 == 1 && config.repetitions > 0 && config.memoryElements > 0 && config.teardownArenas > 0;
+}
+
+int main(int argc, char **argv) {
+	BenchmarkConfig config;
+	if (!parseArguments(argc, argv, config)) {
+		std::cerr << "usage: " << argv[0] << " [--format csv|json] [--output file] [--warmup N]"
+			" [--repetitions N] [--max-operations N] [--outlier-cutoff X]"
+			" [--latency-output file] [--latency-runs N] [--memory-output file] [--memory-elements N]"
+			" [--trace file] [--trace-dir dir] [--seed N] [--profile-elements N] [--profile-operations N]"
+			" [--lru-max-rank N] [--sweep-operations N] [--teardown-output file] [--teardown-arenas N]"
+			" [--teardown-elements N]" << std::endl;
+		return 1;
+	}
+	BenchmarkReport report, latencyReport;
+	PerfCounters counters;
+	if (!counters.anyAvailable())
+		std::cerr << "hardware counters are unavailable, reporting times only" << std::endl;
+	double timerOverhead = timerOverheadNs();
+	const std::vector<size_t> cntOfOpsToTestOn{
+		10000, 30000, 100000, 300000, 1000000, 3000000, 10000000};
+	try {
+		if (!config.trace.empty()) {
+			MappedFile file(config.trace);
+			Operations ops(file.data(), file.size());
+			compareWorkingTime(config, Workload{ "trace", ops, ops.count(), 0 }, report, latencyReport, counters, timerOverhead);
+		}
+		else
+			for (auto num : cntOfOpsToTestOn) {
+				if (num > config.maxOperations)
+					continue;
+				if (config.traceDir.empty()) {
+					std::string encoded = encodeStaticOperations(num, config.seed);
+					Operations ops(encoded.data(), encoded.size());
+					compareWorkingTime(config, Workload{ "static", ops, num, 0 }, report, latencyReport, counters, timerOverhead);
+					continue;
+				}
+				std::string path = config.traceDir + "/static_" + std::to_string(num) + "_seed" + std::to_string(config.seed)
+					+ "_v" + std::to_string(OperationTraceFormat::VERSION) + ".xlot";
+				if (!std::ifstream(path)) {
+					std::string encoded = encodeStaticOperations(num, config.seed);
+					std::ofstream(path, std::ios::binary).write(encoded.data(), encoded.size());
+				}
+				MappedFile file(path);
+				Operations ops(file.data(), file.size());
+				compareWorkingTime(config, Workload{ "static", ops, num, 0 }, report, latencyReport, counters, timerOverhead);
+			}
+		for (size_t profile = 0; config.profileElements != 0 && profile < WORKLOAD_PROFILE_COUNT; profile++) {
+			std::string encoded = encodeProfileOperations(config, WorkloadProfile(profile));
+			Operations ops(encoded.data(), encoded.size());
+			Workload workload{ workloadProfileName(WorkloadProfile(profile)), ops, config.profileOperations,
+				config.profileElements };
+			compareWorkingTime(config, workload, report, latencyReport, counters, timerOverhead);
+		}
+		if (config.sweepOperations != 0) {
+			//the same operations on every element type, so that the rows differ in the element alone
+			std::string encoded = encodeStaticOperations(config.sweepOperations, config.seed);
+			Operations ops(encoded.data(), encoded.size());
+			Workload workload{ "element_sweep", ops, config.sweepOperations, 0 };
+			forEachElement([&](auto tag) {
+				typedef typename decltype(tag)::type Element;
+				compareWorkingTime<Element>(config, workload, report, latencyReport, counters, timerOverhead);
+			});
+		}
+	}
+	catch (const std::runtime_error &error) {
+		std::cerr << error.what() << std::endl;
+		return 1;
+	}
+
+	writeReport(config, report, config.output);
+	if (!config.latencyOutput.empty())
+		writeReport(config, latencyReport, config.latencyOutput);
+	if (!config.memoryOutput.empty()) {
+		BenchmarkReport memoryReport;
+		compareMemory(config, memoryReport);
+		writeReport(config, memoryReport, config.memoryOutput);
+	}
+	if (!config.teardownOutput.empty()) {
+		BenchmarkReport teardownReport;
+		compareTeardown(config, teardownReport);
+		writeReport(config, teardownReport, config.teardownOutput);
+	}
+	return 0;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <sstream>
+#include <algorithm>
+
+//table of named columns, written as CSV or as a JSON array of objects
+class BenchmarkReport {
+public:
+	void beginRow();
+	void add(const std::string &column, const std::string &value);
+	void add(const std::string &column, const char *value);
+	void add(const std::string &column, double value);
+	void add(const std::string &column, size_t value);
+
+	//columns in the order of first appearance, cells a row lacks are left empty
+	void writeCsv(std::ostream &out) const;
+	void writeJson(std::ostream &out) const;
+private:
+	struct _Cell {
+		std::string column;
+		std::string value;
+		bool text;
+	};
+
+	std::vector <std::vector<_Cell> > _rows;
+
+	void addCell(const std::string &column, const std::string &value, bool text);
+	std::vector <std::string> columns() const;
+	static std::string csvEscape(const std::string &value);
+	static std::string jsonEscape(const std::string &value);
+};
+
+inline void BenchmarkReport::beginRow()
+{
+	_rows.emplace_back();
+}
+
+inline void BenchmarkReport::add(const std::string &column, const std::string &value)
+{
+	addCell(column, value, true);
+}
+
+inline void BenchmarkReport::add(const std::string &column, const char *value)
+{
+	addCell(column, value, true);
+}
+
+inline void BenchmarkReport::add(const std::string &column, double value)
+{
+	std::ostringstream out;
+	out.precision(9);
+	out << value;
+	addCell(column, out.str(), false);
+}
+
+inline void BenchmarkReport::add(const std::string &column, size_t value)
+{
+	addCell(column, std::to_string(value), false);
+}
+
+inline void BenchmarkReport::writeCsv(std::ostream &out) const
+{
+	std::vector <std::string> header = columns();
+	for (size_t i = 0; i < header.size(); i++)
+		out << (i == 0 ? "" : ",") << csvEscape(header[i]);
+	out << '\n';
+	for (const auto &row : _rows) {
+		for (size_t i = 0; i < header.size(); i++) {
+			if (i != 0)
+				out << ',';
+			for (const _Cell &cell : row)
+				if (cell.column == header[i]) {
+					out << (cell.text ? csvEscape(cell.value) : cell.value);
+					break;
+				}
+		}
+		out << '\n';
+	}
+}
+
+inline void BenchmarkReport::writeJson(std::ostream &out) const
+{
+	out << "[\n";
+	for (size_t i = 0; i < _rows.size(); i++) {
+		out << "  {";
+		for (size_t j = 0; j < _rows[i].size(); j++) {
+			const _Cell &cell = _rows[i][j];
+			out << (j == 0 ? "" : ", ") << '"' << jsonEscape(cell.column) << "\": ";
+			if (cell.text)
+				out << '"' << jsonEscape(cell.value) << '"';
+			else
+				out << cell.value;
+		}
+		out << (i + 1 == _rows.size() ? "}\n" : "},\n");
+	}
+	out << "]\n";
+}
+
+inline void BenchmarkReport::addCell(const std::string &column, const std::string &value, bool text)
+{
+	if (_rows.empty())
+		beginRow();
+	_rows.back().push_back(_Cell{ column, value, text });
+}
+
+inline std::vector<std::string> BenchmarkReport::columns() const
+{
+	std::vector <std::string> answer;
+	for (const auto &row : _rows)
+		for (const _Cell &cell : row)
+			if (std::find(answer.begin(), answer.end(), cell.column) == answer.end())
+				answer.push_back(cell.column);
+	return answer;
+}
+
+inline std::string BenchmarkReport::csvEscape(const std::string &value)
+{
+	if (value.find_first_of(",\"\n") == std::string::npos)
+		return value;
+	std::string answer = "\"";
+	for (char c : value)
+		answer += c == '"' ? std::string("\"\"") : std::string(1, c);
+	return answer + "\"";
+}
+
+inline std::string BenchmarkReport::jsonEscape(const std::string &value)
+{
+	std::string answer;
+	for (char c : value) {
+		if (c == '"' || c == '\\')
+			answer += '\\';
+		answer += c;
+	}
+	return answer;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+//robust summary of repeated timings
+struct SampleStats {
+	size_t count = 0;
+	size_t rejected = 0; //outliers left out of mean
+	double median = 0;
+	double mad = 0; //median absolute deviation from median
+	double p99 = 0;
+	double mean = 0;
+	double min = 0;
+	double max = 0;
+};
+
+//samples further than outlierCutoff standard deviations (estimated as 1.4826 * MAD) from median
+//are rejected from mean; median, MAD and percentiles are taken over every sample
+SampleStats summarize(std::vector<double> samples, double outlierCutoff = 3.5);
+//nearest-rank percentile of sorted samples, fraction in [0, 1]
+double percentile(const std::vector<double> &sorted, double fraction);
+
+inline double percentile(const std::vector<double> &sorted, double fraction)
+{
+	if (sorted.empty())
+		return 0;
+	size_t rank = size_t(std::ceil(fraction * sorted.size()));
+	return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+inline SampleStats summarize(std::vector<double> samples, double outlierCutoff)
+{
+	SampleStats answer;
+	answer.count = samples.size();
+	if (samples.empty())
+		return answer;
+	std::sort(samples.begin(), samples.end());
+	answer.median = percentile(samples, 0.5);
+	answer.p99 = percentile(samples, 0.99);
+	answer.min = samples.front();
+	answer.max = samples.back();
+	std::vector<double> deviations;
+	for (double sample : samples)
+		deviations.push_back(std::abs(sample - answer.median));
+	std::sort(deviations.begin(), deviations.end());
+	answer.mad = percentile(deviations, 0.5);
+	double limit = outlierCutoff * 1.4826 * answer.mad;
+	double sum = 0;
+	for (double sample : samples) {
+		if (std::abs(sample - answer.median) > limit && answer.mad > 0)
+			answer.rejected++;
+		else
+			sum += sample;
+	}
+	answer.mean = sum / (answer.count - answer.rejected);
+	return answer;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+
+//element of a given size for the payload sweeps
+template <size_t Size>
+struct Payload {
+	char bytes[Size];
+};
+
+//the elements the benchmark sweeps, as the Element of ListOperation::apply: make(value) builds
+//the element an operation on int pushes, digest(element) reads one back into an int
+struct IntElement {
+	typedef int type;
+
+	static std::string name();
+	static int make(int value);
+	static int digest(int element);
+};
+
+template <size_t Size>
+struct PodElement {
+	typedef Payload<Size> type;
+
+	static std::string name();
+	static Payload<Size> make(int value);
+	static int digest(const Payload<Size> &element);
+};
+
+//short enough for the small string buffer of every standard library
+struct ShortStringElement {
+	typedef std::string type;
+
+	static std::string name();
+	static std::string make(int value);
+	static int digest(const std::string &element);
+};
+
+//too long for any small string buffer, so every element allocates
+struct LongStringElement {
+	typedef std::string type;
+	static const size_t LENGTH = 64;
+
+	static std::string name();
+	static std::string make(int value);
+	static int digest(const std::string &element);
+};
+
+//owns its value, so it is only ever moved
+struct MoveOnlyElement {
+	typedef std::unique_ptr<int> type;
+
+	static std::string name();
+	static std::unique_ptr<int> make(int value);
+	static int digest(const std::unique_ptr<int> &element);
+};
+
+inline std::string IntElement::name()
+{
+	return "int";
+}
+
+inline int IntElement::make(int value)
+{
+	return value;
+}
+
+inline int IntElement::digest(int element)
+{
+	return element;
+}
+
+template <size_t Size>
+std::string PodElement<Size>::name()
+{
+	return "pod" + std::to_string(Size);
+}
+
+template <size_t Size>
+Payload<Size> PodElement<Size>::make(int value)
+{
+	Payload<Size> answer = {};
+	std::memcpy(answer.bytes, &value, std::min(sizeof(value), Size));
+	return answer;
+}
+
+template <size_t Size>
+int PodElement<Size>::digest(const Payload<Size> &element)
+{
+	int answer = 0;
+	std::memcpy(&answer, element.bytes, std::min(sizeof(answer), Size));
+	return answer;
+}
+
+inline std::string ShortStringElement::name()
+{
+	return "short_string";
+}
+
+inline std::string ShortStringElement::make(int value)
+{
+	return std::to_string(value);
+}
+
+inline int ShortStringElement::digest(const std::string &element)
+{
+	return element.empty() ? 0 : element.back();
+}
+
+inline std::string LongStringElement::name()
+{
+	return "long_string";
+}
+
+inline std::string LongStringElement::make(int value)
+{
+	std::string answer = std::to_string(value);
+	answer.resize(LENGTH, '.');
+	return answer;
+}
+
+inline int LongStringElement::digest(const std::string &element)
+{
+	return element.empty() ? 0 : element.front();
+}
+
+inline std::string MoveOnlyElement::name()
+{
+	return "move_only";
+}
+
+inline std::unique_ptr<int> MoveOnlyElement::make(int value)
+{
+	return std::unique_ptr<int>(new int(value));
+}
+
+inline int MoveOnlyElement::digest(const std::unique_ptr<int> &element)
+{
+	return *element;
+}
+
+template <class Element>
+struct ElementTag {
+	typedef Element type;
+};
+
+//calls visit(ElementTag<Element>()) for every swept Element, from int up
+template <class Visitor>
+void forEachElement(Visitor visit) {
+	visit(ElementTag<IntElement>());
+	visit(ElementTag<PodElement<8> >());
+	visit(ElementTag<PodElement<16> >());
+	visit(ElementTag<PodElement<32> >());
+	visit(ElementTag<PodElement<64> >());
+	visit(ElementTag<PodElement<128> >());
+	visit(ElementTag<PodElement<256> >());
+	visit(ElementTag<ShortStringElement>());
+	visit(ElementTag<LongStringElement>());
+	visit(ElementTag<MoveOnlyElement>());
+}
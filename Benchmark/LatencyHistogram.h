@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+//log-linear histogram of latencies in the spirit of HdrHistogram: values keep their
+//SUB_BUCKET_BITS most significant bits, so a reported percentile is off by at most 1/16 of it
+class LatencyHistogram {
+public:
+	static const unsigned SUB_BUCKET_BITS = 5;
+
+	LatencyHistogram();
+
+	void record(uint64_t value);
+	void merge(const LatencyHistogram &other);
+
+	uint64_t count() const;
+	uint64_t max() const;
+	//upper bound of the bucket holding the value of nearest rank, fraction in [0, 1]
+	uint64_t percentile(double fraction) const;
+private:
+	static const size_t _HALF_SUB_BUCKETS = size_t(1) << (SUB_BUCKET_BITS - 1);
+	static const size_t _BUCKETS = (66 - SUB_BUCKET_BITS) * _HALF_SUB_BUCKETS;
+
+	std::vector <uint64_t> _counts;
+	uint64_t _count;
+	uint64_t _max;
+
+	static size_t bucketOf(uint64_t value);
+	static uint64_t upperBound(size_t bucket);
+};
+
+inline LatencyHistogram::LatencyHistogram() :
+	_counts(_BUCKETS), _count(0), _max(0)
+{
+	//initialize values
+}
+
+inline void LatencyHistogram::record(uint64_t value)
+{
+	_counts[bucketOf(value)]++;
+	_count++;
+	_max = std::max(_max, value);
+}
+
+inline void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+	for (size_t i = 0; i < _BUCKETS; i++)
+		_counts[i] += other._counts[i];
+	_count += other._count;
+	_max = std::max(_max, other._max);
+}
+
+inline uint64_t LatencyHistogram::count() const
+{
+	return _count;
+}
+
+inline uint64_t LatencyHistogram::max() const
+{
+	return _max;
+}
+
+inline uint64_t LatencyHistogram::percentile(double fraction) const
+{
+	uint64_t rank = std::max<uint64_t>(uint64_t(std::ceil(fraction * _count)), 1);
+	uint64_t seen = 0;
+	for (size_t i = 0; i < _BUCKETS; i++) {
+		seen += _counts[i];
+		if (seen >= rank)
+			return std::min(upperBound(i), _max);
+	}
+	return _max;
+}
+
+inline size_t LatencyHistogram::bucketOf(uint64_t value)
+{
+	if (value < 2 * _HALF_SUB_BUCKETS)
+		return size_t(value); //exact
+	unsigned shift = 0;
+	while ((value >> shift) >= 2 * _HALF_SUB_BUCKETS)
+		shift++;
+	//value >> shift is in [_HALF_SUB_BUCKETS, 2 * _HALF_SUB_BUCKETS)
+	return shift * _HALF_SUB_BUCKETS + size_t(value >> shift);
+}
+
+inline uint64_t LatencyHistogram::upperBound(size_t bucket)
+{
+	if (bucket < 2 * _HALF_SUB_BUCKETS)
+		return bucket;
+	unsigned shift = unsigned(bucket / _HALF_SUB_BUCKETS - 1);
+	uint64_t top = bucket - shift * _HALF_SUB_BUCKETS;
+	return ((top + 1) << shift) - 1;
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <memory>
+#include <fstream>
+#include <algorithm>
+
+#include "../XorList/BlockSource.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+//live and peak bytes of whatever reports to it
+struct MemoryCounter {
+	size_t live = 0;
+	size_t peak = 0;
+
+	void add(size_t bytes);
+	void remove(size_t bytes);
+};
+
+//forwards to Inner, counting the bytes the container asks for
+template <typename T, class Inner = std::allocator<T> >
+class CountingAllocator {
+public:
+	using value_type = T;
+
+	template<class otherClass>
+	struct rebind {
+		using other = CountingAllocator<otherClass,
+			typename std::allocator_traits<Inner>::template rebind_alloc<otherClass> >;
+	};
+
+	CountingAllocator(const Inner &inner, MemoryCounter &counter);
+
+	template <typename otherClass, class otherInner>
+	CountingAllocator(const CountingAllocator <otherClass, otherInner> &other);
+
+	T * allocate(size_t size);
+	void deallocate(T * const ptr, size_t size);
+
+	template <typename otherClass, class otherInner>
+	bool operator ==(const CountingAllocator <otherClass, otherInner> &other) const;
+	template <typename otherClass, class otherInner>
+	bool operator !=(const CountingAllocator <otherClass, otherInner> &other) const;
+private:
+	template <typename otherClass, class otherInner>
+	friend class CountingAllocator;
+
+	Inner _inner;
+	MemoryCounter * _counter;
+};
+
+//counts the bytes of the blocks an arena takes, from malloc and with no cache in between
+class CountingBlockSource : public BlockSource {
+public:
+	explicit CountingBlockSource(MemoryCounter &counter);
+
+	char * acquire(size_t size) override;
+	void release(char * const block, size_t size) override;
+private:
+	MallocBlockSource _upstream;
+	MemoryCounter * _counter;
+};
+
+//resident set size of the process, 0 where /proc/self/statm is missing
+size_t residentBytes();
+//hands memory freed by earlier runs back to the OS where the C library allows it,
+//so that a following residentBytes() delta sees the pages of the next run
+void releaseFreeMemory();
+
+inline void MemoryCounter::add(size_t bytes)
+{
+	live += bytes;
+	peak = std::max(peak, live);
+}
+
+inline void MemoryCounter::remove(size_t bytes)
+{
+	live -= bytes;
+}
+
+template <typename T, class Inner>
+CountingAllocator<T, Inner>::CountingAllocator(const Inner &inner, MemoryCounter &counter) :
+	_inner(inner), _counter(&counter)
+{
+	//initialize values
+}
+
+template <typename T, class Inner>
+template <typename otherClass, class otherInner>
+CountingAllocator<T, Inner>::CountingAllocator(const CountingAllocator <otherClass, otherInner> &other) :
+	_inner(other._inner), _counter(other._counter)
+{
+	//initialize values
+}
+
+template <typename T, class Inner>
+T * CountingAllocator<T, Inner>::allocate(size_t size)
+{
+	T* answer = std::allocator_traits<Inner>::allocate(_inner, size);
+	_counter->add(size * sizeof(T));
+	return answer;
+}
+
+template <typename T, class Inner>
+void CountingAllocator<T, Inner>::deallocate(T * const ptr, size_t size)
+{
+	_counter->remove(size * sizeof(T));
+	std::allocator_traits<Inner>::deallocate(_inner, ptr, size);
+}
+
+template <typename T, class Inner>
+template <typename otherClass, class otherInner>
+bool CountingAllocator<T, Inner>::operator ==(const CountingAllocator <otherClass, otherInner> &other) const
+{
+	return _counter == other._counter && _inner == other._inner;
+}
+
+template <typename T, class Inner>
+template <typename otherClass, class otherInner>
+bool CountingAllocator<T, Inner>::operator !=(const CountingAllocator <otherClass, otherInner> &other) const
+{
+	return !(*this == other);
+}
+
+inline CountingBlockSource::CountingBlockSource(MemoryCounter &counter) :
+	_counter(&counter)
+{
+	//initialize values
+}
+
+inline char * CountingBlockSource::acquire(size_t size)
+{
+	char* answer = _upstream.acquire(size);
+	_counter->add(size);
+	return answer;
+}
+
+inline void CountingBlockSource::release(char * const block, size_t size)
+{
+	_counter->remove(size);
+	_upstream.release(block, size);
+}
+
+inline size_t residentBytes()
+{
+#ifdef __linux__
+	std::ifstream statm("/proc/self/statm");
+	size_t size = 0, resident = 0;
+	if (statm >> size >> resident)
+		return resident * size_t(sysconf(_SC_PAGESIZE));
+#endif
+	return 0;
+}
+
+inline void releaseFreeMemory()
+{
+#ifdef __GLIBC__
+	malloc_trim(0);
+#endif
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#ifdef __linux__
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+//hardware counters of the calling thread through perf_event_open; every event is opened on its own,
+//so the ones the CPU, the kernel (perf_event_paranoid) or a container refuse are just missing
+class PerfCounters {
+public:
+	enum Event {
+		PEcycles,
+		PEinstructions,
+		PEl1d_misses,
+		PEllc_misses,
+		PEdtlb_misses,
+		PEbranch_misses,
+	};
+	static const size_t EVENT_COUNT = size_t(PEbranch_misses) + 1;
+
+	PerfCounters();
+	PerfCounters(const PerfCounters &) = delete;
+	PerfCounters& operator =(const PerfCounters &) = delete;
+	~PerfCounters();
+
+	bool available(Event event) const;
+	//false if no event could be opened, e.g. on Windows
+	bool anyAvailable() const;
+	static const char * eventName(Event event);
+
+	void start();
+	void stop();
+	//count between the last start() and stop(), scaled up if the kernel multiplexed the event
+	uint64_t value(Event event) const;
+private:
+	int _fds[EVENT_COUNT];
+	uint64_t _values[EVENT_COUNT];
+};
+
+inline PerfCounters::PerfCounters()
+{
+	for (size_t i = 0; i < EVENT_COUNT; i++) {
+		_fds[i] = -1;
+		_values[i] = 0;
+	}
+#ifdef __linux__
+	auto cache = [](uint64_t cache, uint64_t op, uint64_t result) {
+		return cache | (op << 8) | (result << 16);
+	};
+	const uint32_t types[EVENT_COUNT] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+		PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE };
+	const uint64_t configs[EVENT_COUNT] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS),
+		cache(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS),
+		cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS),
+		PERF_COUNT_HW_BRANCH_MISSES,
+	};
+	for (size_t i = 0; i < EVENT_COUNT; i++) {
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = types[i];
+		attr.config = configs[i];
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		_fds[i] = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+	}
+#endif
+}
+
+inline PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+	for (int fd : _fds)
+		if (fd != -1)
+			close(fd);
+#endif
+}
+
+inline bool PerfCounters::available(Event event) const
+{
+	return _fds[event] != -1;
+}
+
+inline bool PerfCounters::anyAvailable() const
+{
+	for (int fd : _fds)
+		if (fd != -1)
+			return true;
+	return false;
+}
+
+inline const char * PerfCounters::eventName(Event event)
+{
+	static const char * const names[EVENT_COUNT] = {
+		"cycles",
+		"instructions",
+		"l1d_misses",
+		"llc_misses",
+		"dtlb_misses",
+		"branch_misses",
+	};
+	return names[event];
+}
+
+inline void PerfCounters::start()
+{
+#ifdef __linux__
+	for (int fd : _fds)
+		if (fd != -1) {
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+}
+
+inline void PerfCounters::stop()
+{
+#ifdef __linux__
+	for (int fd : _fds)
+		if (fd != -1)
+			ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+	for (size_t i = 0; i < EVENT_COUNT; i++) {
+		uint64_t data[3] = {}; //value, time enabled, time running
+		if (_fds[i] == -1 || read(_fds[i], data, sizeof(data)) != sizeof(data))
+			_values[i] = 0;
+		else if (data[2] == 0)
+			_values[i] = 0; //never scheduled on the PMU
+		else
+			_values[i] = uint64_t(double(data[0]) * data[1] / data[2]);
+	}
+#endif
+}
+
+inline uint64_t PerfCounters::value(Event event) const
+{
+	return _values[event];
+}
@@ -2,15 +2,49 @@
 #include <iostream>
 #include <algorithm>
 #include <random>
+#include <cstdlib>
 #include <list>
 #include <memory>
 #include <fstream>
+#include <sstream>
 #include <utility>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
 
 #include "../XorList/StackAllocator.h"
+#include "../XorList/BlockReclaimer.h"
+#include "../XorList/PrefaultingBlockSource.h"
+#include "../XorList/IdleTrimmer.h"
+#include "../XorList/StackArenaAllocator.h"
+#include "../XorList/StackMemoryResource.h"
 #include "../XorList/XorList.h"
 #include "../XorList/ListOperation.h"
+#include "../XorList/OperationTrace.h"
+#include "../XorList/TracingXorList.h"
 
+//seed of every generated workload: XORLIST_SEED if set, a new one per run otherwise;
+//main prints it, so that a failing run can be replayed
+uint64_t testSeed;
+
+template <typename T, class List1, class List2>
+void doOperationAndCheck(
+	List1 &list1, List2 &list2, const ListOperation<T> &op, ListCursor<List2> *cursor2 = nullptr) {
+	size_t size_t_answer1, size_t_answer2;
+	T T_answer1, T_answer2;
+	op(list1);
+	size_t_answer1 = ListOperation<T>::last_size_t_answer();
+	T_answer1 = ListOperation<T>::last_T_answer();
+	if (cursor2 != nullptr)
+		op(list2, *cursor2);
+	else
+		op(list2);
+	size_t_answer2 = ListOperation<T>::last_size_t_answer();
+	T_answer2 = ListOperation<T>::last_T_answer();
+	ASSERT_EQ(size_t_answer1, size_t_answer2);
+	ASSERT_EQ(T_answer1, T_answer2);
+}
 
 TEST(TestStackAllocator, SimpleTest) {
 	const int ArraySize = 100;
@@ -32,9 +66,10 @@ class RandomSizedAllocation {
 public:
 	RandomSizedAllocation() = delete;
 	template <class Allocator>
-	RandomSizedAllocation(const Allocator& alloc) {
+	RandomSizedAllocation(const Allocator& alloc, OperationRandom &random) {
+		const size_t MaxRandomSize = 1 << 20;
 		_alloc = alloc;
-		_size = my_rand() % alloc.max_size();
+		_size = random() % std::min(alloc.max_size(), MaxRandomSize);
 		_pointer = _alloc.allocate(_size);
 	}
 	~RandomSizedAllocation() {
@@ -62,12 +97,13 @@ TEST(TestStackAllocator, CopyIntTest) {
 	otherAl2 = otherAl1;
 	otherAl3 = intAl;
 
-	RandomSizedAllocation<StackAllocator <int> > RG1(intAl);
-	RandomSizedAllocation<StackAllocator <int> > RG2(intAl1);
-	RandomSizedAllocation<StackAllocator <int> > RG3(intAl2);
-	RandomSizedAllocation<StackAllocator <int> > RG4(otherAl1);
-	RandomSizedAllocation<StackAllocator <int> > RG5(otherAl2);
-	RandomSizedAllocation<StackAllocator <int> > RG6(otherAl3);
+	OperationRandom random(testSeed);
+	RandomSizedAllocation<StackAllocator <int> > RG1(intAl, random);
+	RandomSizedAllocation<StackAllocator <int> > RG2(intAl1, random);
+	RandomSizedAllocation<StackAllocator <int> > RG3(intAl2, random);
+	RandomSizedAllocation<StackAllocator <int> > RG4(otherAl1, random);
+	RandomSizedAllocation<StackAllocator <int> > RG5(otherAl2, random);
+	RandomSizedAllocation<StackAllocator <int> > RG6(otherAl3, random);
 
 	ASSERT_TRUE(intAl == intAl1);
 	ASSERT_TRUE(intAl1 == intAl2);
@@ -96,6 +132,472 @@ TEST(TestStackAllocator, CopyDiffTest) {
 }
 
 
+TEST(TestStackAllocator, ResetReusesBlocks) {
+	const size_t ChunkSize = 1 << 16;
+	const size_t ChunkCount = 100; //several blocks
+
+	StackAllocator <char> alloc;
+	std::vector <char*> firstPass, secondPass;
+	for (size_t i = 0; i < ChunkCount; i++)
+		firstPass.push_back(alloc.allocate(ChunkSize));
+	alloc.reset();
+	for (size_t i = 0; i < ChunkCount; i++)
+		secondPass.push_back(alloc.allocate(ChunkSize));
+	ASSERT_TRUE(firstPass == secondPass);
+}
+
+TEST(TestStackAllocator, ResetRespectsRetainLimit) {
+	const size_t ChunkSize = 1 << 16;
+	const size_t ChunkCount = 100;
+
+	StackAllocator <char> alloc;
+	alloc.setMaxRetainedBlocks(1);
+	char* first = alloc.allocate(ChunkSize);
+	for (size_t i = 1; i < ChunkCount; i++)
+		alloc.allocate(ChunkSize);
+	alloc.reset();
+	ASSERT_EQ(first, alloc.allocate(ChunkSize));
+	for (size_t i = 1; i < ChunkCount; i++)
+		std::fill_n(alloc.allocate(ChunkSize), ChunkSize, 'a');
+}
+
+TEST(TestStackAllocator, MmapBlockSource) {
+	const size_t ChunkSize = 1 << 16;
+	const size_t ChunkCount = 100;
+
+	for (bool prefault : {false, true}) {
+		MmapBlockSource source(prefault);
+		StackAllocator <char> alloc(source);
+		for (size_t i = 0; i < ChunkCount; i++) {
+			char* chunk = alloc.allocate(ChunkSize);
+			ASSERT_EQ(0, reinterpret_cast<uintptr_t>(chunk) % alignof(std::max_align_t));
+			std::fill_n(chunk, ChunkSize, 'a');
+		}
+	}
+}
+
+TEST(TestStackAllocator, LargeAllocations) {
+	const size_t LargeSize = 1 << 23;
+
+	StackAllocator <char> alloc;
+	char* small1 = alloc.allocate(1);
+	char* large = alloc.allocate(LargeSize);
+	char* small2 = alloc.allocate(1);
+	std::fill_n(large, LargeSize, 'a');
+	ASSERT_TRUE(large + LargeSize <= small1 || small1 + 1 <= large);
+	ASSERT_EQ(small1 + 1, small2); //the bump block kept serving
+
+	std::vector<int, StackAllocator<int> > vec;
+	for (int i = 0; i < (1 << 22); i++)
+		vec.push_back(i);
+	ASSERT_EQ((1 << 22) - 1, vec.back());
+}
+
+TEST(TestStackAllocator, NaturalAlignment) {
+	struct alignas(64) CacheLine {
+		char data[64];
+	};
+
+	StackAllocator <int> intAlloc;
+	int* first = intAlloc.allocate(3);
+	int* second = intAlloc.allocate(3);
+	ASSERT_EQ(first + 3, second);
+
+	StackAllocator <CacheLine> lineAlloc = intAlloc;
+	for (size_t i = 0; i < 100; i++)
+		ASSERT_EQ(0, reinterpret_cast<uintptr_t>(lineAlloc.allocate(1)) % alignof(CacheLine));
+	intAlloc.allocate(1);
+	ASSERT_EQ(0, reinterpret_cast<uintptr_t>(lineAlloc.allocate(1 << 20)) % alignof(CacheLine));
+}
+
+class CountingBlockSource : public BlockSource {
+public:
+	char * acquire(size_t size) override {
+		acquired++;
+		return BlockSource::defaultSource().acquire(size);
+	}
+	void release(char * const block, size_t size) override {
+		released++;
+		BlockSource::defaultSource().release(block, size);
+	}
+	std::atomic <size_t> acquired{0}, released{0};
+};
+
+TEST(TestStackAllocator, LazyFirstBlock) {
+	CountingBlockSource source;
+	{
+		StackAllocator <int> alloc(source);
+		XorList <int, StackAllocator<int> > list(alloc);
+		ASSERT_EQ(0, source.acquired);
+		list.push_back(1);
+		ASSERT_EQ(1, source.acquired);
+	}
+	ASSERT_EQ(1, source.released);
+}
+
+TEST(TestStackAllocator, BlockCacheReuse) {
+	CountingBlockSource upstream;
+	BlockGrowthPolicy fullBlocks;
+	fullBlocks.initialBlockSize = BlockSource::DEFAULT_BLOCK_SIZE;
+	CachingBlockSource cache(upstream, BlockSource::DEFAULT_BLOCK_SIZE, 1);
+	for (size_t i = 0; i < 10; i++) {
+		StackAllocator <int> alloc(cache, fullBlocks);
+		alloc.allocate(1);
+	}
+	ASSERT_EQ(1, upstream.acquired);
+	ASSERT_EQ(1, cache.cachedBlocks());
+	{
+		StackAllocator <char> alloc(cache, fullBlocks);
+		for (size_t i = 0; i < 5; i++) //two blocks
+			alloc.allocate(BlockSource::DEFAULT_BLOCK_SIZE / 4);
+	}
+	ASSERT_EQ(2, upstream.acquired);
+	ASSERT_EQ(1, upstream.released); //above the high-water mark
+	cache.clear();
+	ASSERT_EQ(2, upstream.released);
+}
+
+TEST(TestStackAllocator, BlockCacheSizeClasses) {
+	const size_t ChunkSize = 1 << 10;
+	const size_t ChunkCount = 1000; //several geometrically growing blocks
+
+	CountingBlockSource upstream;
+	CachingBlockSource cache(upstream, BlockSource::DEFAULT_BLOCK_SIZE);
+	for (size_t i = 0; i < 3; i++) {
+		StackAllocator <char> alloc(cache);
+		for (size_t j = 0; j < ChunkCount; j++)
+			alloc.allocate(ChunkSize);
+	}
+	ASSERT_LT(1, upstream.acquired);
+	ASSERT_EQ(upstream.acquired, cache.cachedBlocks()); //the later arenas took every block from the cache
+	ASSERT_EQ(0, upstream.released);
+	cache.clear();
+	ASSERT_EQ(upstream.acquired, upstream.released);
+}
+
+TEST(TestStackAllocator, BlockCacheThreads) {
+	const size_t ThreadCount = 4;
+	CountingBlockSource upstream;
+	BlockGrowthPolicy fullBlocks;
+	fullBlocks.initialBlockSize = BlockSource::DEFAULT_BLOCK_SIZE;
+	{
+		CachingBlockSource cache(upstream, BlockSource::DEFAULT_BLOCK_SIZE);
+		std::vector <std::thread> threads;
+		for (size_t t = 0; t < ThreadCount; t++)
+			threads.emplace_back([&cache, &fullBlocks]() {
+				for (size_t i = 0; i < 1000; i++) {
+					StackAllocator <int> alloc(cache, fullBlocks);
+					*alloc.allocate(1) = int(i);
+				}
+			});
+		for (auto& thread : threads)
+			thread.join();
+		ASSERT_LE(upstream.acquired, ThreadCount);
+	}
+	ASSERT_EQ(upstream.acquired, upstream.released);
+}
+
+class RecordingBlockSource : public CountingBlockSource {
+public:
+	char * acquire(size_t size) override {
+		sizes.push_back(size);
+		blocks.push_back(CountingBlockSource::acquire(size));
+		return blocks.back();
+	}
+	std::vector <size_t> sizes;
+	std::vector <char*> blocks;
+};
+
+TEST(TestStackAllocator, GeometricBlockGrowth) {
+	RecordingBlockSource source;
+	BlockGrowthPolicy policy;
+	policy.initialBlockSize = 1 << 12;
+	policy.maxBlockSize = 1 << 15;
+	{
+		StackAllocator <char> alloc(source, policy);
+		for (size_t i = 0; i < 100; i++)
+			alloc.allocate(1 << 10);
+	}
+	std::vector <size_t> expected{ 1 << 12, 1 << 13, 1 << 14, 1 << 15, 1 << 15, 1 << 15 };
+	ASSERT_TRUE(source.sizes == expected);
+
+	source.sizes.clear();
+	policy.expectedBytes = 10000;
+	{
+		StackAllocator <char> alloc(source, policy);
+		alloc.allocate(1);
+	}
+	ASSERT_EQ(1 << 14, source.sizes.front());
+}
+
+TEST(TestStackAllocator, ResetReplacesSmallBlocks) {
+	const size_t ChunkSize = 1 << 18;
+
+	StackAllocator <char> alloc;
+	for (size_t i = 0; i < 1000; i++)
+		alloc.allocate(64); //4, 8, 16 and 32 KiB blocks
+	alloc.reset();
+	char* chunk = alloc.allocate(ChunkSize);
+	std::fill_n(chunk, ChunkSize, 'a');
+	for (size_t i = 0; i < 1000; i++)
+		std::fill_n(alloc.allocate(64), 64, 'b');
+	ASSERT_EQ('a', chunk[ChunkSize - 1]);
+}
+
+TEST(TestStackAllocator, InPlaceExtension) {
+	StackAllocator <int> alloc;
+	int* buffer = alloc.allocate(10);
+	ASSERT_TRUE(alloc.try_extend(buffer, 10, 100));
+	std::fill_n(buffer, 100, 1);
+	int* other = alloc.allocate(1);
+	ASSERT_EQ(buffer + 100, other);
+	ASSERT_FALSE(alloc.try_extend(buffer, 100, 200)); //no longer the most recent one
+	ASSERT_TRUE(alloc.try_extend(other, 1, 2));
+	ASSERT_FALSE(alloc.try_extend(other, 2, 1 << 20)); //does not fit the block
+
+	StackAllocator <char> charAlloc;
+	auto result = charAlloc.allocate_at_least(3);
+	ASSERT_LE(3, result.count);
+	ASSERT_EQ(0, reinterpret_cast<uintptr_t>(result.ptr + result.count) % alignof(std::max_align_t));
+	ASSERT_EQ(result.ptr + result.count, charAlloc.allocate(1));
+}
+
+TEST(TestStackAllocator, BackgroundReclaimer) {
+	CountingBlockSource source;
+	{
+		BlockReclaimer reclaimer(1); //every other arena waits for the previous one
+		for (size_t i = 0; i < 20; i++) {
+			StackAllocator <int> alloc(source);
+			alloc.setReclaimer(reclaimer);
+			for (size_t j = 0; j < 100; j++)
+				alloc.allocate(1000);
+			alloc.allocate(1 << 20);
+		}
+		reclaimer.drain();
+		ASSERT_EQ(source.acquired, source.released);
+		StackAllocator <int> unused(source);
+		unused.setReclaimer(reclaimer);
+	}
+	ASSERT_EQ(source.acquired, source.released);
+}
+
+TEST(TestStackAllocator, PrefaultingBlockSource) {
+	OperationRandom random(testSeed);
+	CountingBlockSource upstream;
+	{
+		PrefaultingBlockSource source(upstream);
+		source.waitReady();
+		ASSERT_EQ(PrefaultingBlockSource::DEFAULT_DEPTH, upstream.acquired);
+		BlockGrowthPolicy fullBlocks;
+		fullBlocks.initialBlockSize = BlockSource::DEFAULT_BLOCK_SIZE;
+		StackAllocator <int> alloc(source, fullBlocks);
+		XorList <int, StackAllocator<int> > xorList(alloc);
+		std::list <int> STDList;
+		for (auto op : generateRandomLeapOperations<int>(300000, random))
+			doOperationAndCheck(STDList, xorList, op);
+	}
+	ASSERT_EQ(upstream.acquired, upstream.released);
+}
+
+//runs out of memory after limit blocks
+class LimitedBlockSource : public CountingBlockSource {
+public:
+	explicit LimitedBlockSource(size_t limit) : _limit(limit) {
+		//initialize values
+	}
+	char * acquire(size_t size) override {
+		if (acquired == _limit)
+			throw std::bad_alloc();
+		return CountingBlockSource::acquire(size);
+	}
+private:
+	size_t _limit;
+};
+
+TEST(TestStackAllocator, PrefaultingBlockSourceFailure) {
+	LimitedBlockSource upstream(1);
+	{
+		PrefaultingBlockSource source(upstream, BlockSource::DEFAULT_BLOCK_SIZE, 2);
+		ASSERT_THROW(source.waitReady(), std::bad_alloc);
+		char* block = source.acquire(BlockSource::DEFAULT_BLOCK_SIZE); //the one made ready
+		source.release(block, BlockSource::DEFAULT_BLOCK_SIZE);
+		ASSERT_THROW(source.acquire(BlockSource::DEFAULT_BLOCK_SIZE), std::bad_alloc);
+	}
+	ASSERT_EQ(1, upstream.released);
+}
+
+TEST(TestStackAllocator, BlockUsage) {
+	const size_t Header = BasicStackAllocator::BLOCK_HEADER_SIZE;
+	BlockGrowthPolicy policy;
+	policy.initialBlockSize = policy.maxBlockSize = 1 << 12;
+	BasicStackAllocator alloc(BasicStackAllocator::UNLIMITED_RETAINED_BLOCKS, BlockSource::defaultSource(), policy);
+	ASSERT_TRUE(alloc.blockUsage().empty());
+	for (size_t i = 0; i < 5; i++)
+		alloc.allocate(1000, 1);
+	alloc.allocate(1 << 20, 1); //dedicated blocks are not bump blocks
+	std::vector <BasicStackAllocator::BlockUsage> usage = alloc.blockUsage();
+	ASSERT_EQ(2, usage.size());
+	ASSERT_EQ(1 << 12, usage[0].size);
+	ASSERT_EQ(Header + 4000, usage[0].used);
+	ASSERT_EQ(Header + 1000, usage[1].used);
+	alloc.reset();
+	usage = alloc.blockUsage();
+	ASSERT_EQ(2, usage.size());
+	ASSERT_EQ(Header, usage[1].used);
+	alloc.setMaxRetainedBlocks(0);
+	alloc.reset();
+	ASSERT_TRUE(alloc.blockUsage().empty());
+}
+
+TEST(TestStackAllocator, ReleaseUnusedBlocks) {
+	CountingBlockSource source;
+	BlockGrowthPolicy policy;
+	policy.initialBlockSize = policy.maxBlockSize = 1 << 12;
+	BasicStackAllocator alloc(BasicStackAllocator::UNLIMITED_RETAINED_BLOCKS, source, policy);
+	for (size_t i = 0; i < 20; i++)
+		alloc.allocate(1000, 1);
+	alloc.reset();
+	alloc.allocate(1000, 1);
+	alloc.trim(); //spare blocks lose their pages, not their headers
+	ASSERT_EQ(5, alloc.blockUsage().size());
+	for (size_t i = 0; i < 16; i++)
+		std::fill_n(static_cast<char*>(alloc.allocate(1000, 1)), 1000, 'a');
+	alloc.reset();
+	char* first = static_cast<char*>(alloc.allocate(1000, 1));
+	ASSERT_EQ(4 * (1 << 12), alloc.release_unused());
+	ASSERT_EQ(1, alloc.blockUsage().size());
+	ASSERT_EQ(source.acquired - 1, source.released);
+	ASSERT_EQ(first + 1000, alloc.allocate(1000, 1));
+	for (size_t i = 0; i < 3; i++)
+		alloc.allocate(1000, 1); //a released block comes back from the source
+	ASSERT_EQ(2, alloc.blockUsage().size());
+}
+
+//what discard() can give back of [begin, begin + size)
+static size_t wholePages(const char * begin, size_t size) {
+#if defined(_WIN32)
+	return 0;
+#else
+	const uintptr_t page = BlockSource::DISCARD_GRANULARITY;
+	uintptr_t first = (reinterpret_cast<uintptr_t>(begin) + page - 1) & ~(page - 1);
+	uintptr_t last = (reinterpret_cast<uintptr_t>(begin) + size) & ~(page - 1);
+	return first < last ? last - first : 0;
+#endif
+}
+
+TEST(TestStackAllocator, TrimReportsDiscardedPages) {
+	RecordingBlockSource source;
+	BlockGrowthPolicy policy;
+	const size_t blockSize = 1 << 16;
+	policy.initialBlockSize = policy.maxBlockSize = blockSize;
+	BasicStackAllocator alloc(BasicStackAllocator::UNLIMITED_RETAINED_BLOCKS, source, policy);
+	for (size_t i = 0; i < 30; i++)
+		alloc.allocate(3000, 1);
+	ASSERT_EQ(2, source.blocks.size());
+	alloc.reset();
+	char* cursor = static_cast<char*>(alloc.allocate(1000, 1)) + 1000;
+	size_t header = BasicStackAllocator::BLOCK_HEADER_SIZE;
+	size_t expected = wholePages(cursor, source.blocks[0] + blockSize - cursor)
+		+ wholePages(source.blocks[1] + header, blockSize - header);
+#if !defined(_WIN32)
+	ASSERT_LT(0, expected);
+	ASSERT_EQ(0, expected % BlockSource::DISCARD_GRANULARITY);
+#endif
+	ASSERT_EQ(expected, alloc.trim());
+	//discarded pages stay in place and count again
+	ASSERT_EQ(expected, alloc.trim(true));
+}
+
+TEST(TestStackAllocator, IdleTrimmer) {
+	CountingBlockSource source;
+	BlockGrowthPolicy policy;
+	policy.initialBlockSize = policy.maxBlockSize = 1 << 12;
+	IdleTrimmer trimmer(std::chrono::milliseconds(10), std::chrono::milliseconds(5));
+	StackAllocator <char> busy(source, policy), idle(source, policy);
+	busy.setIdleTrimmer(trimmer);
+	idle.setIdleTrimmer(trimmer);
+	for (size_t i = 0; i < 20; i++) {
+		busy.allocate(1000);
+		idle.allocate(1000);
+	}
+	idle.reset();
+	for (auto stop = std::chrono::steady_clock::now() + std::chrono::milliseconds(200); std::chrono::steady_clock::now() < stop; ) {
+		busy.reset();
+		for (size_t i = 0; i < 20; i++)
+			busy.allocate(1000);
+	}
+	ASSERT_EQ(10, source.acquired);
+	ASSERT_EQ(4, source.released); //the spares of the idle arena, none of the busy one
+}
+
+TEST(TestStackAllocator, DoubleEndedArena) {
+	BlockGrowthPolicy policy;
+	policy.initialBlockSize = 1 << 12;
+	policy.doubleEnded = true;
+	BasicStackAllocator alloc(BasicStackAllocator::UNLIMITED_RETAINED_BLOCKS, BlockSource::defaultSource(), policy);
+	char* front = alloc.allocate_front(16);
+	char* back = alloc.allocate(16);
+	ASSERT_EQ(front + 16, back); //both ends start from the middle of the first block
+	for (size_t i = 1; i < 10; i++) {
+		ASSERT_EQ(front - 16, alloc.allocate_front(16));
+		front -= 16;
+	}
+	ASSERT_EQ(0, reinterpret_cast<uintptr_t>(alloc.allocate_front(1, 64)) % 64);
+	for (size_t i = 0; i < 1000; i++)
+		std::fill_n(alloc.allocate_front(16), 16, 'a');
+	ASSERT_LT(2, alloc.blockUsage().size());
+	alloc.reset();
+	ASSERT_EQ(front + 9 * 16, alloc.allocate_front(16));
+	ASSERT_EQ(back, alloc.allocate(16));
+}
+
+TEST(TestStackAllocator, FrontBlocksGrowOnTheirOwn) {
+	RecordingBlockSource source;
+	BlockGrowthPolicy policy;
+	policy.initialBlockSize = 1 << 12;
+	policy.maxBlockSize = 1 << 16;
+	BasicStackAllocator alloc(BasicStackAllocator::UNLIMITED_RETAINED_BLOCKS, source, policy);
+	for (size_t i = 0; i < 30; i++)
+		alloc.allocate(1000, 1);
+	ASSERT_EQ(4, source.sizes.size());
+	alloc.allocate_front(16); //what XorList takes for a push_front
+	std::vector <BasicStackAllocator::BlockUsage> usage = alloc.blockUsage();
+	ASSERT_EQ(5, usage.size());
+	ASSERT_EQ(size_t(1) << 15, usage[3].size);
+	ASSERT_EQ(policy.initialBlockSize, usage[4].size); //not the size the back chain grew to
+	for (size_t i = 0; i < 31; i++)
+		alloc.allocate(1000, 1);
+	std::vector <size_t> expected{ 1 << 12, 1 << 13, 1 << 14, 1 << 15, 1 << 12, 1 << 16 };
+	ASSERT_TRUE(source.sizes == expected);
+}
+
+#ifdef XORLIST_ARENA_STATS
+TEST(TestStackAllocator, Statistics) {
+	BlockGrowthPolicy policy;
+	policy.initialBlockSize = policy.maxBlockSize = 1 << 12;
+	StackAllocator <char> alloc(BlockSource::defaultSource(), policy);
+	StackAllocator <int> intAlloc = alloc;
+	alloc.allocate(1);
+	intAlloc.allocate(1); //3 bytes of padding
+	for (size_t i = 0; i < 5; i++) //the fifth does not fit and wastes the first block's tail
+		alloc.allocate(1000);
+	alloc.allocate(1 << 20); //dedicated block
+	const ArenaStats& stats = alloc.stats();
+	ASSERT_EQ(8, stats.allocations);
+	ASSERT_EQ(1 + 4 + 5000 + (1 << 20), stats.bytesRequested);
+	ASSERT_EQ(1 + 7 + 5000 + (1 << 20), stats.bytesHandedOut);
+	ASSERT_EQ((1 << 12) - BasicStackAllocator::BLOCK_HEADER_SIZE - 4008, stats.bytesWasted);
+	ASSERT_EQ(3, stats.blocksLive);
+	ASSERT_EQ(1, stats.sizeHistogram[1]);
+	ASSERT_EQ(1, stats.sizeHistogram[3]);
+	ASSERT_EQ(5, stats.sizeHistogram[10]);
+	ASSERT_EQ(1, stats.sizeHistogram[21]);
+	alloc.reset();
+	ASSERT_EQ(2, stats.blocksLive);
+	ASSERT_EQ(3, stats.peakBlocks);
+}
+#endif
+
 
 template <typename T, class List1, class List2>
 void testAllocators(
@@ -113,8 +615,9 @@ bool operator ==(const std::vector <T> &vec, const XorList<T> list) {
 }
 
 TEST(TestStackAllocator, STDlist) {
+	OperationRandom random(testSeed);
 	std::list<int, StackAllocator<int> > STDlist;
-	auto ops = generateRandomLeapOperations<int, rand>(10000);
+	auto ops = generateRandomLeapOperations<int>(10000, random);
 	doOperations(STDlist, ops);
 	ASSERT_TRUE(true);
 }
@@ -131,8 +634,9 @@ TEST(TestXorList, SimpleTest) {
 }
 
 TEST(TestXorList, CopyTest) {
+	OperationRandom random(testSeed);
 	XorList<int> intList1;
-	doOperations(intList1, generateRandomStaticOperations<int, rand>(10));
+	doOperations(intList1, generateRandomStaticOperations<int>(10, random));
 	XorList<int> intList2 = intList1;
 	XorList<int> intList3 = intList2;
 	XorList<int> intList4;
@@ -144,6 +648,302 @@ TEST(TestXorList, CopyTest) {
 	ASSERT_FALSE(intList3 == intList4);
 }
 
+TEST(TestXorList, AssignNonEmpty) {
+	XorList<int> intList1, intList2, intList3;
+	intList1.push_back(1);
+	intList2.push_back(2);
+	intList2.push_back(3);
+	intList1 = intList2;
+	ASSERT_TRUE(intList1 == intList2);
+	intList3.push_back(4);
+	intList3 = std::move(intList1);
+	ASSERT_TRUE(intList3 == intList2);
+	ASSERT_TRUE(intList1.empty());
+}
+
+TEST(TestXorList, PmrNestedStrings) {
+	const std::string LongString(100, 'a');
+
+	StackMemoryResource resource;
+	pmr::XorList<std::pmr::string> list(&resource);
+	for (size_t i = 0; i < 1000; i++) {
+		list.push_back(LongString);
+		list.push_front(std::pmr::string(LongString));
+	}
+	for (auto it = list.begin(); it != list.end(); ++it) {
+		ASSERT_EQ(&resource, (*it).get_allocator().resource());
+		ASSERT_EQ(LongString, (*it).c_str());
+	}
+
+	pmr::XorList<std::pmr::string> other(&resource);
+	other = list;
+	ASSERT_TRUE(other == list);
+}
+
+TEST(TestXorList, ArenaHandles) {
+	OperationRandom random(testSeed);
+	StackArena arena;
+	XorList<int, StackArenaAllocator<int> > arenaList(arena);
+	std::list<int, StackArenaAllocator<int> > STDList(arena);
+	ASSERT_EQ(sizeof(void*), sizeof(StackArenaAllocator<int>));
+	ASSERT_LT(sizeof(arenaList), (sizeof(XorList<int, StackAllocator<int> >)));
+	for (auto op : generateRandomLeapOperations<int>(3000, random))
+		doOperationAndCheck(STDList, arenaList, op);
+	XorList<int, StackArenaAllocator<int> > copy = arenaList;
+	ASSERT_TRUE(copy == arenaList);
+}
+
+TEST(TestXorList, DoubleEndedArena) {
+	OperationRandom random(testSeed);
+	BlockGrowthPolicy policy;
+	policy.doubleEnded = true;
+	StackAllocator <int> alloc(BlockSource::defaultSource(), policy);
+	{
+		XorList <int, StackAllocator<int> > xorList(alloc);
+		for (int i = 0; i < 100; i++) {
+			xorList.push_front(-i);
+			xorList.push_back(i);
+		}
+		int* previous = nullptr;
+		for (auto it = xorList.begin(); it != xorList.end(); it++) {
+			ASSERT_LT(previous, &*it); //traversal walks memory upward
+			previous = &*it;
+		}
+	}
+	alloc.reset();
+	XorList <int, StackAllocator<int> > checked(alloc);
+	std::list <int> STDList;
+	for (auto op : generateRandomLeapOperations<int>(30000, random))
+		doOperationAndCheck(STDList, checked, op);
+}
+
+TEST(TestXorList, OperationTrace) {
+	OperationRandom random(testSeed);
+	std::list<ListOperation<int> > ops = generateRandomLeapOperations<int>(30000, random);
+	ops.push_back(ListOperation<int>(ListOperation<int>::LKpush_back, 0, -1));
+	ops.push_back(ListOperation<int>(ListOperation<int>::LKpush_back, 0, 1 << 30));
+	ops.push_back(ListOperation<int>(ListOperation<int>::LKget_by_iterator_from_begin, 1, 0));
+	ops.push_back(ListOperation<int>(ListOperation<int>::LKinsert_at, 1, -7));
+	ops.push_back(ListOperation<int>(ListOperation<int>::LKmove_to_front, 2, 0));
+	ops.push_back(ListOperation<int>(ListOperation<int>::LKerase_at, 1, 0));
+	{
+		std::ofstream file("Operation_trace.xlot", std::ios::binary);
+		OperationTraceWriter<int>(file).writeAll(ops);
+	}
+	MappedFile file("Operation_trace.xlot");
+	OperationTrace<int> trace(file.data(), file.size());
+	ASSERT_EQ(ops.size(), trace.count());
+	auto it = ops.begin();
+	for (const ListOperation<int> &op : trace) {
+		ASSERT_EQ(it->kind(), op.kind());
+		ASSERT_EQ(it->size_t_value(), op.size_t_value());
+		if (op.kind() == ListOperation<int>::LKpush_back || op.kind() == ListOperation<int>::LKpush_front
+			|| op.kind() == ListOperation<int>::LKinsert_at) {
+			ASSERT_EQ(it->T_value(), op.T_value());
+		}
+		++it;
+	}
+	std::list<int> STDList;
+	XorList<int> xorList;
+	doOperations(STDList, ops);
+	trace.replay(xorList);
+	ASSERT_EQ(STDList.size(), xorList.size());
+	ASSERT_TRUE(std::equal(STDList.begin(), STDList.end(), xorList.begin()));
+	ASSERT_THROW(OperationTrace<long long>(file.data(), file.size()), std::runtime_error);
+
+	std::string header(file.data(), OperationTraceFormat::HEADER_SIZE);
+	for (std::string malformed : { header + char(200), //unknown kind
+		header + char(ListOperation<int>::LKerase_at) + std::string(11, char(0x80)) + char(1), //overlong varint
+		header + char(ListOperation<int>::LKinsert_at) + char(0x85) }) { //truncated
+		OperationTrace<int> malformedTrace(malformed.data(), malformed.size());
+		ASSERT_THROW(malformedTrace.count(), std::runtime_error);
+	}
+	std::string version1 = header, version3 = header;
+	version1[sizeof(OperationTraceFormat::MAGIC)] = 1;
+	version3[sizeof(OperationTraceFormat::MAGIC)] = 3;
+	ASSERT_THROW(OperationTrace<int>(version3.data(), version3.size()), std::runtime_error);
+	version1 += std::string(1, char(ListOperation<int>::LKpush_back)) + char(2);
+	ASSERT_EQ(1, OperationTrace<int>(version1.data(), version1.size()).count());
+	version1 += std::string(1, char(ListOperation<int>::LKerase_at)) + char(0); //unknown to version 1
+	ASSERT_THROW(OperationTrace<int>(version1.data(), version1.size()).count(), std::runtime_error);
+}
+
+TEST(TestXorList, TracingXorList) {
+	OperationRandom random(testSeed);
+	std::list<ListOperation<int> > ops = generateRandomLeapOperations<int>(30000, random);
+	std::ostringstream out;
+	TracingXorList<int> tracingList(out);
+	ASSERT_TRUE(tracingList.traced());
+	doOperations(tracingList, ops);
+	tracingList.flush();
+	std::string data = out.str();
+	OperationTrace<int> trace(data.data(), data.size());
+	std::list<int> STDList;
+	trace.replay(STDList);
+	ASSERT_EQ(STDList.size(), tracingList.inner().size());
+	ASSERT_TRUE(std::equal(STDList.begin(), STDList.end(), tracingList.inner().begin()));
+
+	TraceSampler sampler("Tracing_list_", 2);
+	TracingXorList<int> first(sampler), second(sampler), third(sampler);
+	ASSERT_TRUE(first.traced());
+	ASSERT_FALSE(second.traced());
+	ASSERT_TRUE(third.traced());
+	second.push_back(1);
+	ASSERT_EQ(1, second.front());
+}
+
+//the trace of list replayed into a std::list has to give the elements of list
+template <class Tracing>
+void checkReplay(Tracing &list, const std::ostringstream &out) {
+	list.flush();
+	std::string data = out.str();
+	OperationTrace<int> trace(data.data(), data.size());
+	std::list<int> STDList;
+	trace.replay(STDList);
+	ASSERT_EQ(STDList.size(), list.inner().size());
+	ASSERT_TRUE(std::equal(STDList.begin(), STDList.end(), list.inner().begin()));
+}
+
+TEST(TestXorList, TracingIteratorOperations) {
+	{
+		std::ostringstream out;
+		TracingXorList<int> list(out);
+		list.push_back(1);
+		list.insert_after(list.begin(), 2);
+		list.erase(list.begin());
+		list.push_back(3);
+		auto first = list.begin();
+		list.push_back(4);
+		list.push_back(5);
+		ASSERT_EQ(2, *first); //two changes behind, found again from begin()
+		list.insert_after(first, 6);
+		checkReplay(list, out);
+	}
+
+	OperationRandom random(testSeed);
+	std::ostringstream out;
+	TracingXorList<int> list(out);
+	for (size_t i = 0; i < 3000; i++) {
+		size_t position = list.empty() ? 0 : random() % list.size();
+		auto it = list.begin();
+		for (size_t j = 0; j < position; j++)
+			++it;
+		auto before = it; //stays valid over the change, kept for the next one
+		switch (list.empty() ? 0 : random() % 4) {
+		case 0:
+			list.insert_before(it, int(i));
+			break;
+		case 1:
+			list.insert_after(it, int(i));
+			break;
+		case 2:
+			if (position == 0)
+				break;
+			--before;
+			list.erase(it);
+			list.insert_after(before, int(i)); //an iterator one change behind
+			break;
+		default:
+			ASSERT_EQ(*it, *std::next(list.inner().begin(), position));
+			list.pop_front();
+			break;
+		}
+	}
+	size_t size = 0;
+	for (auto it = list.end(); it != list.begin(); --it)
+		size++;
+	ASSERT_EQ(list.size(), size);
+	checkReplay(list, out);
+
+	std::ostringstream profileOut;
+	TracingXorList<int> profileList(profileOut);
+	ListCursor<TracingXorList<int> > cursor;
+	WorkloadParameters parameters;
+	parameters.profile = WPlru;
+	parameters.size = 300;
+	for (const auto &op : ProfileStream<int>(parameters, 3000, random))
+		op(profileList, cursor);
+	checkReplay(profileList, profileOut);
+}
+
+TEST(TestXorList, UntracedIteratorOperations) {
+	TraceSampler sampler("Tracing_list_", 2);
+	TracingXorList<int> traced(sampler), list(sampler);
+	ASSERT_FALSE(list.traced());
+	OperationRandom random(testSeed);
+	std::list<int> STDList;
+	for (size_t i = 0; i < 3000; i++) {
+		size_t position = list.empty() ? 0 : random() % list.size();
+		auto it = list.begin();
+		auto STDIt = STDList.begin();
+		for (size_t j = 0; j < position; j++, ++STDIt)
+			++it;
+		switch (list.empty() ? 0 : random() % 3) {
+		case 0:
+			list.insert_before(it, int(i));
+			STDList.insert(STDIt, int(i));
+			break;
+		case 1:
+			ASSERT_EQ(*STDIt, *it);
+			list.erase(it);
+			STDList.erase(STDIt);
+			break;
+		default:
+			list.push_front(int(i));
+			STDList.push_front(int(i));
+			list.pop_back();
+			STDList.pop_back();
+			break;
+		}
+	}
+	ASSERT_EQ(STDList.size(), list.size());
+	ASSERT_TRUE(std::equal(STDList.begin(), STDList.end(), list.begin()));
+
+	std::ostringstream out;
+	TracingXorList<int> stale(out);
+	for (int i = 0; i < 3; i++)
+		stale.push_back(i);
+	auto second = std::next(stale.begin());
+	stale.erase(stale.begin()); //next to second, which is invalid from now on
+	stale.push_back(3);
+	ASSERT_THROW(*second, std::logic_error);
+}
+
+TEST(TestXorList, WorkloadProfiles) {
+	const size_t DrawCount = 100000;
+	OperationRandom keyRandom(testSeed);
+	ZipfDistribution keys(1000, 1.0);
+	size_t firstRank = 0;
+	for (size_t i = 0; i < DrawCount; i++) {
+		uint64_t rank = keys(keyRandom);
+		ASSERT_TRUE(rank >= 1 && rank <= 1000);
+		firstRank += rank == 1;
+	}
+	ASSERT_NEAR(0.1336, double(firstRank) / DrawCount, 0.01); //1 / H(1000)
+
+	for (size_t profile = 0; profile < WORKLOAD_PROFILE_COUNT; profile++) {
+		OperationRandom random(testSeed);
+		WorkloadParameters parameters;
+		parameters.profile = WorkloadProfile(profile);
+		parameters.size = 1000;
+		std::list<int> STDList;
+		XorList<int> xorList;
+		ListCursor<XorList<int> > cursor;
+		for (const auto &op : ProfileStream<int>(parameters, 30000, random)) {
+			if (op.kind() == ListOperation<int>::LKmove_to_front) {
+				ASSERT_LE(op.size_t_value(), parameters.lruMaxRank);
+			}
+			doOperationAndCheck(STDList, xorList, op, &cursor);
+		}
+		ASSERT_EQ(STDList.size(), xorList.size());
+		ASSERT_TRUE(std::equal(STDList.begin(), STDList.end(), xorList.begin()));
+	}
+}
+
+bool sameOperation(const ListOperation<int> &op1, const ListOperation<int> &op2) {
+	return op1.kind() == op2.kind() && op1.size_t_value() == op2.size_t_value() && op1.T_value() == op2.T_value();
+}
+
 void testWithSTDList(std::list<ListOperation<int> > ops) {
 	std::list<int> STDList;
 	XorList<int> xorList;
@@ -151,89 +951,164 @@ void testWithSTDList(std::list<ListOperation<int> > ops) {
 		doOperationAndCheck(STDList, xorList, op);
 }
 
+TEST(TestXorList, GenerationInChunks) {
+	const size_t OperationCount = 3 * GENERATION_CHUNK + 100;
+	auto single = generateRandomStaticOperationsInChunks<int>(OperationCount, testSeed, 1);
+	auto parallel = generateRandomStaticOperationsInChunks<int>(OperationCount, testSeed, 4);
+	ASSERT_EQ(OperationCount, parallel.size());
+	ASSERT_TRUE(std::equal(single.begin(), single.end(), parallel.begin(), sameOperation));
+	testWithSTDList(parallel);
+
+	//every chunk continues the list of the one before, so growing stops at the limit of a single stream
+	auto growing = generateInChunks<int>({ { 3 * GENERATION_CHUNK, GFcreate } }, testSeed);
+	std::list<int> STDList;
+	size_t maxSize = 0;
+	for (const auto &op : growing) {
+		op(STDList);
+		maxSize = std::max(maxSize, STDList.size());
+	}
+	ASSERT_EQ(GENERATION_MAX_SIZE, maxSize);
+}
+
+TEST(TestXorList, OperationStreams) {
+	const size_t OperationCount = 10000;
+	OperationRandom listRandom(testSeed), streamRandom(testSeed);
+	size_t size = 0;
+	std::list<ListOperation<int> > ops = generate_operation_list<int>(OperationCount / 10, size, listRandom, GFcreate);
+	join(ops, generate_operation_list<int>(OperationCount - OperationCount / 10, size, listRandom, GFno_specification));
+	auto stream = streamRandomStaticOperations<int>(OperationCount, streamRandom);
+	ASSERT_EQ(OperationCount, stream.remaining());
+	ASSERT_TRUE(std::equal(ops.begin(), ops.end(), stream.begin(), stream.end(), sameOperation));
+	ASSERT_TRUE(stream.done());
+	ASSERT_EQ(listRandom(), streamRandom());
+
+	//skipping draws what drawing does, also at both size limits
+	std::vector<OperationStream<int>::Phase> phases{ { 4 * GENERATION_MAX_SIZE, GFcreate },
+		{ 4 * GENERATION_MAX_SIZE, GFfree }, { OperationCount, GFno_specification } };
+	OperationRandom drawRandom(testSeed), skipRandom(testSeed);
+	OperationStream<int> drawn(phases, drawRandom), skipped(phases, skipRandom);
+	size_t maxSize = 0;
+	while (!drawn.done()) {
+		drawn.next();
+		skipped.skip();
+		ASSERT_EQ(drawn.size(), skipped.size());
+		maxSize = std::max(maxSize, skipped.size());
+	}
+	ASSERT_TRUE(skipped.done());
+	ASSERT_EQ(GENERATION_MAX_SIZE, maxSize);
+	ASSERT_EQ(drawRandom(), skipRandom());
+
+	OperationRandom random(testSeed);
+	std::list<int> STDList;
+	XorList<int> xorList;
+	for (const auto &op : streamRandomLadderOperations<int>(OperationCount, random))
+		doOperationAndCheck(STDList, xorList, op);
+}
+
+//move-only elements, for operations on int applied through ListOperation::apply
+struct BoxedElement {
+	typedef std::unique_ptr<int> type;
+
+	static std::unique_ptr<int> make(int value) { return std::unique_ptr<int>(new int(value)); }
+	static int digest(const std::unique_ptr<int> &element) { return *element; }
+};
+
+TEST(TestXorList, MoveOnlyElements) {
+	OperationRandom random(testSeed);
+	WorkloadParameters parameters;
+	parameters.profile = WPlru;
+	parameters.size = 1000;
+	std::list<int> STDList;
+	XorList<std::unique_ptr<int> > xorList;
+	ListCursor<XorList<std::unique_ptr<int> > > cursor;
+	for (const auto &op : ProfileStream<int>(parameters, 10000, random)) {
+		op(STDList);
+		size_t size_t_answer = ListOperation<int>::last_size_t_answer();
+		int T_answer = ListOperation<int>::last_T_answer();
+		op.apply<BoxedElement>(xorList, cursor);
+		ASSERT_EQ(size_t_answer, ListOperation<int>::last_size_t_answer());
+		ASSERT_EQ(T_answer, ListOperation<int>::last_T_answer());
+	}
+	ASSERT_EQ(STDList.size(), xorList.size());
+	ASSERT_TRUE(std::equal(STDList.begin(), STDList.end(), xorList.begin(),
+		[](int value, const std::unique_ptr<int> &element) { return value == *element; }));
+}
+
 TEST(TestXorList, CompareWithSTDList1) {
-	testWithSTDList(generateRandomStaticOperations<int, rand>(100));
+	OperationRandom random(testSeed);
+	testWithSTDList(generateRandomStaticOperations<int>(100, random));
 }
 
 TEST(TestXorList, CompareWithSTDList2) {
-	testWithSTDList(generateRandomStaticOperations<int, rand>(3000));
+	OperationRandom random(testSeed);
+	testWithSTDList(generateRandomStaticOperations<int>(3000, random));
 }
 
 TEST(TestXorList, CompareWithSTDList3) {
-	testWithSTDList(generateRandomStaticOperations<int, rand>(10000));
+	OperationRandom random(testSeed);
+	testWithSTDList(generateRandomStaticOperations<int>(10000, random));
 }
 
 TEST(TestXorList, CompareWithSTDListLeap1) {
-	testWithSTDList(generateRandomLeapOperations<int, rand>(100));
+	OperationRandom random(testSeed);
+	testWithSTDList(generateRandomLeapOperations<int>(100, random));
 }
 
 TEST(TestXorList, CompareWithSTDListLeap2) {
-	testWithSTDList(generateRandomLeapOperations<int, rand>(3000));
+	OperationRandom random(testSeed);
+	testWithSTDList(generateRandomLeapOperations<int>(3000, random));
 }
 
 TEST(TestXorList, CompareWithSTDListLeap3) {
-	testWithSTDList(generateRandomLeapOperations<int, rand>(10000));
+	OperationRandom random(testSeed);
+	testWithSTDList(generateRandomLeapOperations<int>(10000, random));
 }
 
 TEST(TestXorList, CompareWithSTDListLadder1) {
-	testWithSTDList(generateRandomLadderOperations<int, rand>(100));
+	OperationRandom random(testSeed);
+	testWithSTDList(generateRandomLadderOperations<int>(100, random));
 }
 
 TEST(TestXorList, CompareWithSTDListLadder2) {
-	testWithSTDList(generateRandomLadderOperations<int, rand>(3000));
+	OperationRandom random(testSeed);
+	testWithSTDList(generateRandomLadderOperations<int>(3000, random));
 }
 
 TEST(TestXorList, CompareWithSTDListLadder3) {
-	testWithSTDList(generateRandomLadderOperations<int, rand>(10000));
+	OperationRandom random(testSeed);
+	testWithSTDList(generateRandomLadderOperations<int>(10000, random));
 }
 
-template <typename T>
-void printOnWidth(std::ofstream &out, const T& data) {
-	static const size_t WIDTH = 30;
-	out << std::setw(WIDTH) << data;
-}
+//a list and the only allocator left of its arena, so that destroying it destroys the arena too
+struct ArenaList {
+	StackAllocator<int> alloc;
+	XorList<int, StackAllocator<int> > list;
 
-template <class List>
-double workingTime(List &list, std::list<ListOperation<int> > ops) {
-	clock_t begTime = clock();
-	for (auto op : ops)
-		op(list);
-	clock_t endTime = clock();
-	return double(endTime - begTime) / CLOCKS_PER_SEC;
-}
-
-void compareWorkingTime(size_t numOfOps, std::ofstream &result) {
-	std::list<ListOperation<int> > ops = generateRandomStaticOperations<int, rand>(numOfOps);
-	std::list<int, std::allocator<int> > STDlist1;
-	std::list<int, StackAllocator<int> > STDlist2;
-	XorList<int, std::allocator<int> > xorList1;
-	XorList<int, StackAllocator<int> > xorList2;
-	printOnWidth(result, numOfOps);
-	printOnWidth(result, workingTime(STDlist1, ops));
-	printOnWidth(result, workingTime(STDlist2, ops));
-	printOnWidth(result, workingTime(xorList1, ops));
-	printOnWidth(result, workingTime(xorList2, ops));
-	result << std::endl;
-}
-
-TEST(TestXorList, CompareWorkingTimeDependingOnAllocator) {
-	std::ofstream result("Working_time_compare_result.txt");
-
-	result.fill(' ');
-	printOnWidth(result, "Amont of operations");
-	printOnWidth(result, "std::list<std::allocator>");
-	printOnWidth(result, "std::list<StackAlloc>");
-	printOnWidth(result, "XorList<std::allocator>");
-	printOnWidth(result, "XorList<StackAlloc>");
-	result <<  std::endl << std::fixed << std::setprecision(3);
-	const std::vector<size_t> cntOfOpsToTestOn{
-		10000, 30000, 100000, 300000, 1000000, 3000000, 10000000};
-	for (auto num : cntOfOpsToTestOn)
-		compareWorkingTime(num, result);
-	result.close();
+	explicit ArenaList(BlockSource &source) : alloc(source), list(alloc) {
+		//initialize values
+	}
+};
+
+TEST(TestXorList, ReclaimerReleasesListBlocks) {
+	CountingBlockSource source;
+	BlockReclaimer reclaimer;
+	for (size_t i = 0; i < 10; i++) {
+		auto list = std::make_unique<ArenaList>(source);
+		list->alloc.setReclaimer(reclaimer);
+		for (int j = 0; j < 100000; j++)
+			list->list.push_back(j);
+		list.reset(); //hands the blocks over, the reclaimer releases them
+	}
+	reclaimer.drain();
+	ASSERT_LT(10, source.acquired);
+	ASSERT_EQ(source.acquired, source.released);
 }
 
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
+	const char *seed = std::getenv("XORLIST_SEED");
+	std::random_device device;
+	testSeed = seed != nullptr ? std::strtoull(seed, nullptr, 10) : (uint64_t(device()) << 32) | device();
+	std::cout << "XORLIST_SEED=" << testSeed << std::endl;
 	return RUN_ALL_TESTS();
 }
\ No newline at end of file
@@ -1,27 +1,98 @@
 #include "BasicStackAllocator.h"
+#include "BlockReclaimer.h"
+#include "IdleTrimmer.h"
 
-BasicStackAllocator::BasicStackAllocator()
+const size_t BasicStackAllocator::UNLIMITED_RETAINED_BLOCKS;
+const size_t BasicStackAllocator::BLOCK_HEADER_SIZE;
+
+BasicStackAllocator::BasicStackAllocator(size_t maxRetainedBlocks, BlockSource & source,
+	const BlockGrowthPolicy & policy) :
+	_source(&source), _first(nullptr), _current(nullptr), _cursor(nullptr), _limit(nullptr),
+	_frontFirst(nullptr), _frontCurrent(nullptr), _frontCursor(nullptr), _frontLimit(nullptr),
+	_doubleEnded(policy.doubleEnded),
+	_maxRetainedBlocks(maxRetainedBlocks), _nextFrontBlockSize(policy.initialBlockSize), _maxBlockSize(std::max(policy.maxBlockSize, policy.initialBlockSize)),
+	_largeThreshold(_maxBlockSize / 4), _largeBlocks(nullptr), _reclaimer(nullptr), _trimmer(nullptr),
+	_lastActivity(0)
 {
-	addBlock();
+	assert(policy.initialBlockSize > BLOCK_HEADER_SIZE);
+	_nextBlockSize = policy.initialBlockSize;
+	while (_nextBlockSize < policy.expectedBytes + BLOCK_HEADER_SIZE && _nextBlockSize < _maxBlockSize)
+		_nextBlockSize = std::min(_nextBlockSize * 2, _maxBlockSize);
+	//the first block is acquired by the first allocation
 }
 
 BasicStackAllocator::~BasicStackAllocator()
 {
-	while (!_blocks.empty()) {
-		free(_blocks.top());
-		_blocks.pop();
+	if (_trimmer != nullptr)
+		_trimmer->remove(this);
+	if (_reclaimer != nullptr && (_first != nullptr || _frontFirst != nullptr || _largeBlocks != nullptr))
+		_reclaimer->reclaim(DetachedBlocks{ _source, _first, _frontFirst, _largeBlocks });
+	else {
+		releaseChain(_first);
+		releaseChain(_frontFirst);
+		releaseChain(_largeBlocks);
 	}
 }
 
-char * BasicStackAllocator::allocate(size_t size)
+char * BasicStackAllocator::allocate(size_t size, size_t alignment)
 {
-	if (_position + size > _BLOCK_SIZE)
-		addBlock();
-	if (size > _BLOCK_SIZE)
-		throw std::bad_alloc();
-	char* answer = _blocks.top() + _position;
-	_position += ((size - 1) / _ALIGN + 1) * _ALIGN; //allocates _ALIGN memory if size == 0 
-	return answer;
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+	if (size > _largeThreshold || alignment > _largeThreshold)
+		return allocateLarge(size, alignment);
+	size = std::max<size_t>(size, 1); //distinct pointers for size == 0
+	//computed on integers, as _cursor and _limit are null until the first block
+	uintptr_t answer = alignUp(reinterpret_cast<uintptr_t>(_cursor), alignment);
+	if (answer + size > reinterpret_cast<uintptr_t>(_limit)) {
+		addBlock(size + (alignment > _ALIGN ? alignment : 0)); //blocks start _ALIGN aligned
+		answer = alignUp(reinterpret_cast<uintptr_t>(_cursor), alignment);
+	}
+	XORLIST_ARENA_STAT(recordAllocation(size, answer + size - reinterpret_cast<uintptr_t>(_cursor)));
+	_cursor = reinterpret_cast<char*>(answer + size);
+	return reinterpret_cast<char*>(answer);
+}
+
+char * BasicStackAllocator::allocate_front(size_t size, size_t alignment)
+{
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+	if (size > _largeThreshold || alignment > _largeThreshold)
+		return allocateLarge(size, alignment);
+	size = std::max<size_t>(size, 1);
+	if (_doubleEnded && _current == nullptr)
+		addBlock(size + (alignment > _ALIGN ? alignment : 0)); //the front half gets as much room
+	uintptr_t cursor = reinterpret_cast<uintptr_t>(_frontCursor);
+	uintptr_t answer = (cursor - size) & ~uintptr_t(alignment - 1);
+	if (cursor - reinterpret_cast<uintptr_t>(_frontLimit) < size || answer < reinterpret_cast<uintptr_t>(_frontLimit)) {
+		addFrontBlock(size + (alignment > _ALIGN ? alignment : 0)); //blocks end _ALIGN aligned
+		cursor = reinterpret_cast<uintptr_t>(_frontCursor);
+		answer = (cursor - size) & ~uintptr_t(alignment - 1);
+	}
+	XORLIST_ARENA_STAT(recordAllocation(size, cursor - answer));
+	_frontCursor = reinterpret_cast<char*>(answer);
+	return _frontCursor;
+}
+
+BasicStackAllocator::AllocationResult BasicStackAllocator::allocate_at_least(size_t size, size_t alignment)
+{
+	char* answer = allocate(size, alignment);
+	if (size > _largeThreshold || alignment > _largeThreshold)
+		return AllocationResult{ answer, size };
+	uintptr_t end = std::min(alignUp(reinterpret_cast<uintptr_t>(_cursor), _ALIGN), reinterpret_cast<uintptr_t>(_limit));
+	XORLIST_ARENA_STAT(_stats.bytesHandedOut += end - reinterpret_cast<uintptr_t>(_cursor));
+	_cursor = reinterpret_cast<char*>(end);
+	return AllocationResult{ answer, size_t(_cursor - answer) };
+}
+
+bool BasicStackAllocator::try_extend(char * const ptr, size_t oldSize, size_t newSize)
+{
+	if (_cursor == nullptr || ptr + std::max<size_t>(oldSize, 1) != _cursor)
+		return false; //not the most recent allocation, or a dedicated block
+	if (newSize > size_t(_limit - ptr))
+		return false;
+	newSize = std::max<size_t>(newSize, 1);
+	XORLIST_ARENA_STAT(_stats.bytesRequested += newSize - std::max<size_t>(oldSize, 1));
+	XORLIST_ARENA_STAT(_stats.bytesHandedOut += newSize - std::max<size_t>(oldSize, 1));
+	_cursor = ptr + newSize;
+	return true;
 }
 
 void BasicStackAllocator::deallocate(char * const ptr, size_t size)
@@ -31,11 +102,307 @@ void BasicStackAllocator::deallocate(char * const ptr, size_t size)
 
 size_t BasicStackAllocator::max_size()
 {
-	return _BLOCK_SIZE;
+	return std::numeric_limits<size_t>::max() / 2;
+}
+
+void BasicStackAllocator::reset()
+{
+	auto lock = lockChain();
+	touch();
+	retainBlocks(_first);
+	retainBlocks(_frontFirst);
+	releaseChain(_largeBlocks);
+	_largeBlocks = nullptr;
+	_current = _first;
+	if (_current == nullptr)
+		_cursor = _limit = nullptr;
+	else {
+		_cursor = reinterpret_cast<char*>(_current) + BLOCK_HEADER_SIZE;
+		_limit = reinterpret_cast<char*>(_current) + _current->size;
+	}
+	_frontCurrent = _frontFirst;
+	if (_doubleEnded && _current != nullptr)
+		splitBlock();
+	else if (_frontCurrent == nullptr)
+		_frontCursor = _frontLimit = nullptr;
+	else {
+		_frontLimit = reinterpret_cast<char*>(_frontCurrent) + BLOCK_HEADER_SIZE;
+		_frontCursor = reinterpret_cast<char*>(_frontCurrent) + _frontCurrent->size;
+	}
+}
+
+void BasicStackAllocator::setMaxRetainedBlocks(size_t count)
+{
+	_maxRetainedBlocks = count;
+}
+
+void BasicStackAllocator::setReclaimer(BlockReclaimer * reclaimer)
+{
+	_reclaimer = reclaimer;
+}
+
+size_t BasicStackAllocator::release_unused()
+{
+	auto lock = lockChain();
+	return releaseSpareBlocks();
+}
+
+size_t BasicStackAllocator::trim(bool lazy)
+{
+	auto lock = lockChain();
+	size_t answer = 0;
+	if (_current != nullptr) {
+		answer += _source->discard(_cursor, _limit - _cursor, lazy);
+		answer += discardChain(_current->next, lazy);
+	}
+	if (_frontCursor != nullptr)
+		answer += _source->discard(_frontLimit, _frontCursor - _frontLimit, lazy);
+	answer += discardChain(_frontCurrent == nullptr ? _frontFirst : _frontCurrent->next, lazy);
+	return answer;
 }
 
-void BasicStackAllocator::addBlock()
+void BasicStackAllocator::setIdleTrimmer(IdleTrimmer * trimmer)
 {
-	_blocks.push(reinterpret_cast<char*>(malloc(_BLOCK_SIZE)));
-	_position = 0;
+	if (_trimmer != nullptr)
+		_trimmer->remove(this);
+	_trimmer = trimmer;
+	touch();
+	if (_trimmer != nullptr)
+		_trimmer->add(this);
 }
+
+std::vector<BasicStackAllocator::BlockUsage> BasicStackAllocator::blockUsage() const
+{
+	auto lock = lockChain();
+	std::vector <BlockUsage> answer;
+	for (_BlockHeader* block = _first; block != nullptr; block = block->next) {
+		size_t used = block == _current ? _cursor - reinterpret_cast<char*>(block) : block->used;
+		answer.push_back(BlockUsage{ block->size, used });
+	}
+	for (_BlockHeader* block = _frontFirst; block != nullptr; block = block->next) {
+		size_t used = block != _frontCurrent ? block->used
+			: BLOCK_HEADER_SIZE + (reinterpret_cast<char*>(block) + block->size - _frontCursor);
+		answer.push_back(BlockUsage{ block->size, used });
+	}
+	return answer;
+}
+
+void BasicStackAllocator::addBlock(size_t minSize)
+{
+	auto lock = lockChain();
+	touch();
+	XORLIST_ARENA_STAT(_stats.bytesWasted += _limit - _cursor);
+	bool split = _doubleEnded && _current == nullptr;
+	if (split)
+		minSize = 2 * (minSize + _ALIGN); //either half has to fit the request
+	_BlockHeader* next = nextBlock(_first, _current, minSize + BLOCK_HEADER_SIZE, _nextBlockSize);
+	if (_current != nullptr)
+		_current->used = _cursor - reinterpret_cast<char*>(_current);
+	_current = next;
+	_cursor = reinterpret_cast<char*>(_current) + BLOCK_HEADER_SIZE;
+	_limit = reinterpret_cast<char*>(_current) + _current->size;
+	if (split)
+		splitBlock();
+}
+
+void BasicStackAllocator::addFrontBlock(size_t minSize)
+{
+	auto lock = lockChain();
+	touch();
+	XORLIST_ARENA_STAT(_stats.bytesWasted += _frontCursor - _frontLimit);
+	_BlockHeader* next = nextBlock(_frontFirst, _frontCurrent, minSize + BLOCK_HEADER_SIZE, _nextFrontBlockSize);
+	if (_frontCurrent != nullptr)
+		_frontCurrent->used = BLOCK_HEADER_SIZE + (reinterpret_cast<char*>(_frontCurrent) + _frontCurrent->size - _frontCursor);
+	_frontCurrent = next;
+	_frontLimit = reinterpret_cast<char*>(_frontCurrent) + BLOCK_HEADER_SIZE;
+	_frontCursor = reinterpret_cast<char*>(_frontCurrent) + _frontCurrent->size;
+}
+
+BasicStackAllocator::_BlockHeader * BasicStackAllocator::nextBlock(_BlockHeader *& first, _BlockHeader * current, size_t minSize, size_t & nextBlockSize)
+{
+	_BlockHeader*& link = current == nullptr ? first : current->next;
+	_BlockHeader* next = link;
+	if (next != nullptr && next->size < minSize) { //kept by reset() but too small, replace it
+		link = next->next;
+		if (next->next != nullptr)
+			next->next->prev = current;
+		releaseBlock(next);
+		next = nullptr;
+	}
+	if (next == nullptr) {
+		size_t size = nextBlockSize;
+		while (size < minSize)
+			size *= 2;
+		nextBlockSize = std::min(size * 2, _maxBlockSize);
+		next = acquireBlock(size);
+		next->prev = current;
+		next->next = link;
+		if (next->next != nullptr)
+			next->next->prev = next;
+		link = next;
+	}
+	return next;
+}
+
+void BasicStackAllocator::retainBlocks(_BlockHeader *& first)
+{
+	_BlockHeader* kept = nullptr;
+	_BlockHeader* block = first;
+	for (size_t count = 0; block != nullptr && count < _maxRetainedBlocks; count++) {
+		block->used = BLOCK_HEADER_SIZE;
+		kept = block;
+		block = block->next;
+	}
+	releaseChain(block);
+	if (kept != nullptr)
+		kept->next = nullptr;
+	else
+		first = nullptr;
+}
+
+void BasicStackAllocator::splitBlock()
+{
+	_frontCurrent = nullptr;
+	_frontLimit = _cursor;
+	_cursor = _frontCursor = reinterpret_cast<char*>(alignUp(reinterpret_cast<uintptr_t>(_cursor) + (_limit - _cursor) / 2, _ALIGN));
+}
+
+BasicStackAllocator::_BlockHeader * BasicStackAllocator::acquireBlock(size_t size)
+{
+	_BlockHeader* block = reinterpret_cast<_BlockHeader*>(_source->acquire(size));
+	block->prev = block->next = nullptr;
+	block->size = size;
+	block->used = BLOCK_HEADER_SIZE;
+	XORLIST_ARENA_STAT(recordBlocks(1));
+	return block;
+}
+
+void BasicStackAllocator::releaseBlock(_BlockHeader * block)
+{
+	_source->release(reinterpret_cast<char*>(block), block->size);
+	XORLIST_ARENA_STAT(recordBlocks(-1));
+}
+
+char * BasicStackAllocator::allocateLarge(size_t size, size_t alignment)
+{
+	if (size > max_size())
+		throw std::bad_alloc();
+	size_t padding = alignment > _ALIGN ? alignment - _ALIGN : 0; //sources align to _ALIGN
+	_BlockHeader* block = acquireBlock(BLOCK_HEADER_SIZE + size + padding);
+	block->used = block->size;
+	block->next = _largeBlocks;
+	if (_largeBlocks != nullptr)
+		_largeBlocks->prev = block;
+	_largeBlocks = block;
+	XORLIST_ARENA_STAT(recordAllocation(size, size + padding));
+	return reinterpret_cast<char*>(alignUp(reinterpret_cast<uintptr_t>(block) + BLOCK_HEADER_SIZE, alignment));
+}
+
+void BasicStackAllocator::releaseChain(_BlockHeader * block)
+{
+	while (block != nullptr) {
+		_BlockHeader* next = block->next;
+		releaseBlock(block);
+		block = next;
+	}
+}
+
+void BasicStackAllocator::releaseChain(BlockSource * source, _BlockHeader * block)
+{
+	while (block != nullptr) {
+		_BlockHeader* next = block->next;
+		source->release(reinterpret_cast<char*>(block), block->size);
+		block = next;
+	}
+}
+
+std::unique_lock<std::mutex> BasicStackAllocator::lockChain() const
+{
+	if (_trimmer == nullptr)
+		return std::unique_lock<std::mutex>();
+	return std::unique_lock<std::mutex>(_chainMutex);
+}
+
+void BasicStackAllocator::touch()
+{
+	if (_trimmer != nullptr)
+		_lastActivity.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+size_t BasicStackAllocator::releaseSpareBlocks()
+{
+	size_t answer = 0;
+	if (_current != nullptr)
+		answer += releaseSpareChain(_current->next);
+	answer += releaseSpareChain(_frontCurrent == nullptr ? _frontFirst : _frontCurrent->next);
+	return answer;
+}
+
+size_t BasicStackAllocator::releaseSpareChain(_BlockHeader *& spare)
+{
+	size_t answer = 0;
+	for (_BlockHeader* block = spare; block != nullptr; block = block->next)
+		answer += block->size;
+	releaseChain(spare);
+	spare = nullptr;
+	return answer;
+}
+
+size_t BasicStackAllocator::discardChain(_BlockHeader * block, bool lazy)
+{
+	size_t answer = 0;
+	for (; block != nullptr; block = block->next) {
+		//the header has to survive
+		answer += _source->discard(reinterpret_cast<char*>(block) + BLOCK_HEADER_SIZE, block->size - BLOCK_HEADER_SIZE, lazy);
+	}
+	return answer;
+}
+
+void BasicStackAllocator::releaseUnusedIfIdle(std::chrono::steady_clock::time_point idleSince)
+{
+	if (_lastActivity.load(std::memory_order_relaxed) > idleSince.time_since_epoch().count())
+		return;
+	auto lock = lockChain();
+	releaseSpareBlocks();
+}
+
+void BasicStackAllocator::DetachedBlocks::release()
+{
+	releaseChain(source, bumpBlocks);
+	releaseChain(source, frontBlocks);
+	releaseChain(source, largeBlocks);
+	bumpBlocks = frontBlocks = largeBlocks = nullptr;
+}
+
+uintptr_t BasicStackAllocator::alignUp(uintptr_t address, size_t alignment)
+{
+	return (address + alignment - 1) & ~uintptr_t(alignment - 1);
+}
+
+#ifdef XORLIST_ARENA_STATS
+
+const ArenaStats& BasicStackAllocator::stats() const
+{
+	return _stats;
+}
+
+void BasicStackAllocator::recordAllocation(size_t requested, size_t handedOut)
+{
+	_stats.bytesRequested += requested;
+	_stats.bytesHandedOut += handedOut;
+	_stats.allocations++;
+	size_t bucket = 0;
+	while (requested > 0 && bucket + 1 < ArenaStats::HISTOGRAM_BUCKETS) {
+		requested >>= 1;
+		bucket++;
+	}
+	_stats.sizeHistogram[bucket]++;
+}
+
+void BasicStackAllocator::recordBlocks(ptrdiff_t change)
+{
+	_stats.blocksLive += change;
+	_stats.peakBlocks = std::max(_stats.peakBlocks, _stats.blocksLive);
+}
+
+#endif
@@ -1,22 +1,186 @@
 #pragma once
 
-#include <stack>
+#include <vector>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <assert.h>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+#include "BlockSource.h"
+
+//counters of an arena, compiled in only with XORLIST_ARENA_STATS defined
+struct ArenaStats {
+	static const size_t HISTOGRAM_BUCKETS = 8 * sizeof(size_t);
+
+	size_t bytesRequested = 0;
+	size_t bytesHandedOut = 0; //including alignment padding
+	size_t bytesWasted = 0; //left unused at the ends of abandoned blocks
+	size_t blocksLive = 0;
+	size_t peakBlocks = 0;
+	size_t allocations = 0;
+	//allocations with size in [2^(i-1), 2^i)
+	size_t sizeHistogram[HISTOGRAM_BUCKETS] = {};
+};
+
+#ifdef XORLIST_ARENA_STATS
+#define XORLIST_ARENA_STAT(statement) statement
+#else
+#define XORLIST_ARENA_STAT(statement)
+#endif
+
+class BlockReclaimer;
+class IdleTrimmer;
+
+//blocks start at initialBlockSize and double with every new block up to maxBlockSize
+struct BlockGrowthPolicy {
+	size_t initialBlockSize = size_t(1) << 12;
+	size_t maxBlockSize = BlockSource::DEFAULT_BLOCK_SIZE;
+	//expected amount of memory, the first block is made big enough for it (up to maxBlockSize)
+	size_t expectedBytes = 0;
+	//splits the first block at its middle: allocate_front grows down from there and allocate up,
+	//so memory built from both ends stays in order
+	bool doubleEnded = false;
+};
 
 class BasicStackAllocator {
+	//every block starts with this header, linking it into the chain of the arena
+	struct _BlockHeader {
+		_BlockHeader * prev;
+		_BlockHeader * next;
+		size_t size; //whole block, header included
+		size_t used; //header included, only kept up to date for blocks left behind
+	};
 public:
-	BasicStackAllocator();
+	static const size_t UNLIMITED_RETAINED_BLOCKS = SIZE_MAX;
+	static const size_t BLOCK_HEADER_SIZE = (sizeof(_BlockHeader) + alignof(std::max_align_t) - 1)
+		/ alignof(std::max_align_t) * alignof(std::max_align_t);
+
+	struct BlockUsage {
+		size_t size;
+		size_t used;
+	};
+
+	struct AllocationResult {
+		char * ptr;
+		size_t size;
+	};
+
+	//every block of an arena, cut loose from it in O(1)
+	struct DetachedBlocks {
+		BlockSource * source;
+		_BlockHeader * bumpBlocks;
+		_BlockHeader * frontBlocks;
+		_BlockHeader * largeBlocks;
+
+		void release();
+	};
+
+	//source has to outlive the allocator
+	explicit BasicStackAllocator(size_t maxRetainedBlocks = UNLIMITED_RETAINED_BLOCKS,
+		BlockSource & source = BlockSource::defaultSource(),
+		const BlockGrowthPolicy & policy = BlockGrowthPolicy());
 	~BasicStackAllocator();
 
-	char * allocate(size_t size);
+	//alignment has to be a power of two
+	char * allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+	//like allocate, but takes memory growing downward: consecutive calls return decreasing addresses,
+	//from the middle of the first block with BlockGrowthPolicy::doubleEnded and from blocks of their own after it
+	char * allocate_front(size_t size, size_t alignment = alignof(std::max_align_t));
+	//like allocate, but also hands out the padding up to the next max_align_t boundary
+	AllocationResult allocate_at_least(size_t size, size_t alignment = alignof(std::max_align_t));
+	//resizes the most recent allocation in place in O(1), if its block has room;
+	//returns false (and leaves the allocation alone) otherwise
+	bool try_extend(char * const ptr, size_t oldSize, size_t newSize);
 	void deallocate(char * const ptr, size_t size);
 	size_t max_size();
+
+	//forgets every allocation and restarts from the first block,
+	//keeping at most maxRetainedBlocks blocks for reuse at each end
+	//no block is acquired before the first allocation
+	void reset();
+	void setMaxRetainedBlocks(size_t count);
+	//hands the blocks to reclaimer on destruction instead of releasing them in place;
+	//the reclaimer has to outlive the allocator, nullptr releases in place again
+	void setReclaimer(BlockReclaimer * reclaimer);
+
+	//releases the blocks kept by reset() that the arena has not reached again, returns their size
+	size_t release_unused();
+	//returns the memory of those blocks and the free tail of the current block to the OS,
+	//but keeps the blocks (lazy uses MADV_FREE where available), returns the bytes of whole
+	//pages the source actually gave back
+	size_t trim(bool lazy = false);
+	//lets trimmer call release_unused() once the arena has been idle, i.e. taken no new block
+	//and seen no reset(), for its idle time; the trimmer has to outlive the allocator
+	void setIdleTrimmer(IdleTrimmer * trimmer);
+
+	//bump blocks from the oldest to the newest, followed by the blocks of allocate_front;
+	//blocks kept by reset() report only their header as used
+	std::vector <BlockUsage> blockUsage() const;
+
+#ifdef XORLIST_ARENA_STATS
+	const ArenaStats& stats() const;
+#endif
 private:
 	static const size_t _ALIGN = alignof(std::max_align_t);
-	static const size_t _BLOCK_SIZE = (1 << 17) * _ALIGN;
 
-	std::stack <char*> _blocks;
-	size_t _position;
+	BlockSource * _source;
+	_BlockHeader * _first;
+	_BlockHeader * _current; //the block _cursor points into, nullptr before the first block
+	char * _cursor;
+	char * _limit;
+	//allocate_front counterparts: _frontCursor moves down to _frontLimit,
+	//_frontCurrent is nullptr while it is in the first block (or before any block)
+	_BlockHeader * _frontFirst;
+	_BlockHeader * _frontCurrent;
+	char * _frontCursor;
+	char * _frontLimit;
+	bool _doubleEnded;
+	size_t _maxRetainedBlocks;
+	size_t _nextBlockSize;
+	//the front chain grows on its own, so that a push_front doesn't take a block of the back's size
+	size_t _nextFrontBlockSize;
+	size_t _maxBlockSize;
+	//bigger requests get a block of their own, so a bump block never loses more than this
+	size_t _largeThreshold;
+	_BlockHeader * _largeBlocks;
+	BlockReclaimer * _reclaimer;
+	IdleTrimmer * _trimmer;
+	//guards the chain against the trimmer's thread, only locked with a trimmer set
+	mutable std::mutex _chainMutex;
+	std::atomic <std::chrono::steady_clock::rep> _lastActivity;
+
+	void addBlock(size_t minSize);
+	void addFrontBlock(size_t minSize);
+	//the block after current in the chain starting at first, reused if big enough, acquired otherwise
+	//with a size taken from nextBlockSize, which then doubles
+	_BlockHeader * nextBlock(_BlockHeader *& first, _BlockHeader * current, size_t minSize, size_t & nextBlockSize);
+	//keeps at most _maxRetainedBlocks blocks of the chain, all emptied
+	void retainBlocks(_BlockHeader *& first);
+	//makes the allocations of both ends start from the middle of [_cursor, _limit)
+	void splitBlock();
+	size_t releaseSpareChain(_BlockHeader *& spare);
+	size_t discardChain(_BlockHeader * block, bool lazy);
+	_BlockHeader * acquireBlock(size_t size);
+	void releaseBlock(_BlockHeader * block);
+	char * allocateLarge(size_t size, size_t alignment);
+	static uintptr_t alignUp(uintptr_t address, size_t alignment);
+	void releaseChain(_BlockHeader * block);
+	static void releaseChain(BlockSource * source, _BlockHeader * block);
+	std::unique_lock <std::mutex> lockChain() const;
+	void touch();
+	size_t releaseSpareBlocks();
+
+	friend class IdleTrimmer;
+	void releaseUnusedIfIdle(std::chrono::steady_clock::time_point idleSince);
+
+#ifdef XORLIST_ARENA_STATS
+	ArenaStats _stats;
 
-	void addBlock();
+	void recordAllocation(size_t requested, size_t handedOut);
+	void recordBlocks(ptrdiff_t change);
+#endif
 };
@@ -0,0 +1,56 @@
+#include "BlockReclaimer.h"
+
+const size_t BlockReclaimer::DEFAULT_MAX_PENDING;
+
+BlockReclaimer::BlockReclaimer(size_t maxPending) :
+	_queue(std::max<size_t>(maxPending, 1)), _head(0), _pending(0), _queued(0), _stop(false)
+{
+	_worker = std::thread(&BlockReclaimer::work, this);
+}
+
+BlockReclaimer::~BlockReclaimer()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_changed.notify_all();
+	_worker.join();
+}
+
+void BlockReclaimer::reclaim(const BasicStackAllocator::DetachedBlocks & blocks)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_changed.wait(lock, [this]() { return _queued < _queue.size(); });
+	_queue[(_head + _queued) % _queue.size()] = blocks;
+	_queued++;
+	_pending++;
+	lock.unlock();
+	_changed.notify_all();
+}
+
+void BlockReclaimer::drain()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_changed.wait(lock, [this]() { return _pending == 0; });
+}
+
+void BlockReclaimer::work()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true) {
+		_changed.wait(lock, [this]() { return _queued > 0 || _stop; });
+		if (_queued == 0)
+			return; //stopped and drained
+		BasicStackAllocator::DetachedBlocks blocks = _queue[_head];
+		_head = (_head + 1) % _queue.size();
+		_queued--;
+		lock.unlock();
+		_changed.notify_all(); //room for a waiting reclaim()
+		blocks.release();
+		lock.lock();
+		_pending--;
+		if (_pending == 0)
+			_changed.notify_all();
+	}
+}
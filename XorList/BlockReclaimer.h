@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BasicStackAllocator.h"
+
+//releases the blocks of destroyed arenas on a background thread, so that the
+//destroying thread only pays for handing the block chain over;
+//the block sources involved have to be thread-safe and outlive the reclaimer
+class BlockReclaimer {
+public:
+	static const size_t DEFAULT_MAX_PENDING = 64;
+
+	explicit BlockReclaimer(size_t maxPending = DEFAULT_MAX_PENDING);
+	BlockReclaimer(const BlockReclaimer &) = delete;
+	BlockReclaimer& operator =(const BlockReclaimer &) = delete;
+	~BlockReclaimer();
+
+	//blocks the caller while maxPending chains are already waiting (backpressure)
+	void reclaim(const BasicStackAllocator::DetachedBlocks & blocks);
+	//waits until every chain handed over so far is released
+	void drain();
+private:
+	std::vector <BasicStackAllocator::DetachedBlocks> _queue; //ring buffer of maxPending chains
+	size_t _head;
+	size_t _pending; //queued or being released
+	size_t _queued;
+	bool _stop;
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	std::thread _worker;
+
+	void work();
+};
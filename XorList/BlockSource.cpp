@@ -0,0 +1,237 @@
+#include "BlockSource.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+const size_t BlockSource::DEFAULT_BLOCK_SIZE;
+const size_t BlockSource::DISCARD_GRANULARITY;
+const size_t CachingBlockSource::DEFAULT_HIGH_WATER_MARK;
+const size_t CachingBlockSource::MAX_HIGH_WATER_MARK;
+const size_t CachingBlockSource::SIZE_CLASSES;
+
+BlockSource & BlockSource::defaultSource()
+{
+	static MallocBlockSource mallocSource;
+	static CachingBlockSource source(mallocSource, DEFAULT_BLOCK_SIZE);
+	return source;
+}
+
+size_t BlockSource::discard(char * const begin, size_t size, bool lazy)
+{
+#if !defined(_WIN32)
+	uintptr_t first = (reinterpret_cast<uintptr_t>(begin) + DISCARD_GRANULARITY - 1) & ~(DISCARD_GRANULARITY - 1);
+	uintptr_t last = (reinterpret_cast<uintptr_t>(begin) + size) & ~(DISCARD_GRANULARITY - 1);
+	if (first >= last)
+		return 0;
+	int advice = MADV_DONTNEED;
+#ifdef MADV_FREE
+	if (lazy)
+		advice = MADV_FREE;
+#endif
+	if (madvise(reinterpret_cast<void*>(first), last - first, advice) != 0)
+		return 0;
+	return last - first;
+#else
+	//VirtualAlloc(MEM_RESET) leaves the contents undefined instead of zeroed, so nothing is given back
+	return 0;
+#endif
+}
+
+char * MallocBlockSource::acquire(size_t size)
+{
+	char* block = reinterpret_cast<char*>(malloc(size));
+	if (block == nullptr)
+		throw std::bad_alloc();
+	return block;
+}
+
+void MallocBlockSource::release(char * const block, size_t size)
+{
+	free(block);
+}
+
+CachingBlockSource::CachingBlockSource(BlockSource & upstream, size_t blockSize, size_t highWaterMark) :
+	_upstream(&upstream), _blockSize(blockSize), _highWaterMark(0),
+	_cachedBlocks(new std::atomic<size_t>[SIZE_CLASSES]),
+	_slots(new std::atomic<char*>[SIZE_CLASSES * MAX_HIGH_WATER_MARK])
+{
+	for (size_t i = 0; i < SIZE_CLASSES; i++)
+		_cachedBlocks[i].store(0, std::memory_order_relaxed);
+	for (size_t i = 0; i < SIZE_CLASSES * MAX_HIGH_WATER_MARK; i++)
+		_slots[i].store(nullptr, std::memory_order_relaxed);
+	setHighWaterMark(highWaterMark);
+}
+
+CachingBlockSource::~CachingBlockSource()
+{
+	clear();
+}
+
+char * CachingBlockSource::acquire(size_t size)
+{
+	size_t sizeClass = this->sizeClass(size);
+	if (sizeClass < SIZE_CLASSES && _cachedBlocks[sizeClass].load(std::memory_order_relaxed) > 0) {
+		std::atomic<char*>* slots = &_slots[sizeClass * MAX_HIGH_WATER_MARK];
+		for (size_t i = 0; i < MAX_HIGH_WATER_MARK; i++)
+			if (slots[i].load(std::memory_order_relaxed) != nullptr) {
+				//exchange hands the block to exactly one thread, so there is no ABA problem
+				char* block = slots[i].exchange(nullptr, std::memory_order_acquire);
+				if (block != nullptr) {
+					_cachedBlocks[sizeClass].fetch_sub(1, std::memory_order_relaxed);
+					return block;
+				}
+			}
+	}
+	return _upstream->acquire(size);
+}
+
+void CachingBlockSource::release(char * const block, size_t size)
+{
+	size_t sizeClass = this->sizeClass(size);
+	if (sizeClass < SIZE_CLASSES) {
+		std::atomic<char*>* slots = &_slots[sizeClass * MAX_HIGH_WATER_MARK];
+		size_t highWaterMark = _highWaterMark.load(std::memory_order_relaxed);
+		for (size_t i = 0; i < highWaterMark; i++) {
+			if (slots[i].load(std::memory_order_relaxed) != nullptr)
+				continue;
+			//counted before publishing, so that a racing acquire never drives the counter below zero
+			_cachedBlocks[sizeClass].fetch_add(1, std::memory_order_relaxed);
+			char* expected = nullptr;
+			if (slots[i].compare_exchange_strong(expected, block, std::memory_order_release))
+				return;
+			_cachedBlocks[sizeClass].fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+	_upstream->release(block, size);
+}
+
+void CachingBlockSource::setHighWaterMark(size_t count)
+{
+	_highWaterMark.store(std::min(count, MAX_HIGH_WATER_MARK), std::memory_order_relaxed);
+}
+
+size_t CachingBlockSource::cachedBlocks() const
+{
+	size_t answer = 0;
+	for (size_t i = 0; i < SIZE_CLASSES; i++)
+		answer += _cachedBlocks[i].load(std::memory_order_relaxed);
+	return answer;
+}
+
+void CachingBlockSource::clear()
+{
+	for (size_t i = 0; i < SIZE_CLASSES * MAX_HIGH_WATER_MARK; i++) {
+		char* block = _slots[i].exchange(nullptr, std::memory_order_acquire);
+		if (block != nullptr) {
+			size_t sizeClass = i / MAX_HIGH_WATER_MARK;
+			_cachedBlocks[sizeClass].fetch_sub(1, std::memory_order_relaxed);
+			_upstream->release(block, _blockSize >> sizeClass);
+		}
+	}
+}
+
+size_t CachingBlockSource::sizeClass(size_t size) const
+{
+	for (size_t i = 0; i < SIZE_CLASSES; i++)
+		if (size << i == _blockSize)
+			return i;
+		else if (size << i > _blockSize)
+			break;
+	return SIZE_CLASSES;
+}
+
+MmapBlockSource::MmapBlockSource(bool prefault) : _prefault(prefault)
+{
+	//initialize values
+}
+
+#if defined(_WIN32)
+
+char * MmapBlockSource::acquire(size_t size)
+{
+	char* block = reinterpret_cast<char*>(VirtualAlloc(
+		nullptr, mappedSize(size), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+	if (block == nullptr)
+		throw std::bad_alloc();
+	if (_prefault)
+		for (size_t offset = 0; offset < size; offset += _PAGE_SIZE)
+			block[offset] = 0;
+	return block;
+}
+
+void MmapBlockSource::release(char * const block, size_t size)
+{
+	VirtualFree(block, 0, MEM_RELEASE);
+}
+
+bool MmapBlockSource::hugePagesAvailable()
+{
+	return false; //large pages need SeLockMemoryPrivilege, which we do not ask for
+}
+
+#else
+
+char * MmapBlockSource::acquire(size_t size)
+{
+	size_t length = mappedSize(size);
+	//a block too small for a huge page is neither aligned nor advised, a bigger one
+	//over-maps by one huge page so that an aligned region can be cut out of the mapping
+	size_t slack = length < _HUGE_PAGE_SIZE ? 0 : _HUGE_PAGE_SIZE;
+	char* region = reinterpret_cast<char*>(mmap(nullptr, length + slack,
+		PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	if (region == MAP_FAILED)
+		throw std::bad_alloc();
+	char* block = region;
+	if (slack > 0) {
+		uintptr_t address = reinterpret_cast<uintptr_t>(region);
+		size_t head = (_HUGE_PAGE_SIZE - address % _HUGE_PAGE_SIZE) % _HUGE_PAGE_SIZE;
+		block = region + head;
+		if (head > 0)
+			munmap(region, head);
+		munmap(block + length, _HUGE_PAGE_SIZE - head);
+#ifdef MADV_HUGEPAGE
+		madvise(block, length, MADV_HUGEPAGE); //fails harmlessly when THP is disabled
+#endif
+	}
+	if (_prefault) {
+#ifdef MADV_POPULATE_WRITE
+		if (madvise(block, length, MADV_POPULATE_WRITE) == 0)
+			return block;
+#endif
+		for (size_t offset = 0; offset < length; offset += _PAGE_SIZE)
+			block[offset] = 0;
+	}
+	return block;
+}
+
+void MmapBlockSource::release(char * const block, size_t size)
+{
+	munmap(block, mappedSize(size));
+}
+
+bool MmapBlockSource::hugePagesAvailable()
+{
+	std::ifstream settings("/sys/kernel/mm/transparent_hugepage/enabled");
+	std::string line;
+	if (!std::getline(settings, line))
+		return false;
+	return line.find("[never]") == std::string::npos;
+}
+
+#endif
+
+size_t MmapBlockSource::mappedSize(size_t size)
+{
+	size_t granularity = size < _HUGE_PAGE_SIZE ? _PAGE_SIZE : _HUGE_PAGE_SIZE;
+	return (size + granularity - 1) / granularity * granularity;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+//where BasicStackAllocator takes its blocks from and returns them to
+class BlockSource {
+public:
+	static const size_t DEFAULT_BLOCK_SIZE = (1 << 17) * alignof(std::max_align_t);
+	//discard() only gives back whole pages of this size
+	static const size_t DISCARD_GRANULARITY = size_t(1) << 12;
+
+	virtual ~BlockSource() = default;
+
+	virtual char * acquire(size_t size) = 0;
+	virtual void release(char * const block, size_t size) = 0;
+	//returns the physical pages lying completely inside [begin, begin + size) to the OS, keeping
+	//the address range usable; they read as zeros (lazy: as zeros or old data) afterwards,
+	//returns the bytes actually given back (0 where the platform can't)
+	virtual size_t discard(char * const begin, size_t size, bool lazy = false);
+
+	//malloc behind the process-wide cache of blocks up to DEFAULT_BLOCK_SIZE
+	static BlockSource & defaultSource();
+};
+
+class MallocBlockSource : public BlockSource {
+public:
+	char * acquire(size_t size) override;
+	void release(char * const block, size_t size) override;
+};
+
+//keeps up to highWaterMark released blocks of every size class for the next acquire: blockSize
+//and its halvings down to blockSize >> (SIZE_CLASSES - 1), the sizes a geometrically growing arena
+//takes; safe to share between threads, both paths are lock-free
+class CachingBlockSource : public BlockSource {
+public:
+	static const size_t DEFAULT_HIGH_WATER_MARK = 16;
+	static const size_t MAX_HIGH_WATER_MARK = 256;
+	static const size_t SIZE_CLASSES = 10;
+
+	//upstream has to outlive the cache
+	CachingBlockSource(BlockSource & upstream, size_t blockSize,
+		size_t highWaterMark = DEFAULT_HIGH_WATER_MARK);
+	~CachingBlockSource();
+
+	char * acquire(size_t size) override;
+	void release(char * const block, size_t size) override;
+
+	void setHighWaterMark(size_t count);
+	//of all size classes
+	size_t cachedBlocks() const;
+	//returns every cached block to upstream
+	void clear();
+private:
+	BlockSource * _upstream;
+	size_t _blockSize;
+	std::atomic <size_t> _highWaterMark;
+	std::unique_ptr <std::atomic<size_t>[]> _cachedBlocks; //per size class
+	//MAX_HIGH_WATER_MARK slots per size class, nullptr when empty
+	std::unique_ptr <std::atomic<char*>[]> _slots;
+
+	//SIZE_CLASSES if blocks of size are not cached
+	size_t sizeClass(size_t size) const;
+};
+
+//maps blocks directly from the OS: blocks of 2 MiB and more are 2 MiB aligned and advised as
+//transparent huge pages, smaller ones only rounded up to whole pages;
+//with prefault set every page is touched before the block is handed out
+class MmapBlockSource : public BlockSource {
+public:
+	explicit MmapBlockSource(bool prefault = false);
+
+	char * acquire(size_t size) override;
+	void release(char * const block, size_t size) override;
+
+	static bool hugePagesAvailable();
+private:
+	static const size_t _HUGE_PAGE_SIZE = size_t(1) << 21;
+	static const size_t _PAGE_SIZE = size_t(1) << 12;
+
+	bool _prefault;
+
+	static size_t mappedSize(size_t size);
+};
@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <assert.h>
+#include "IdleTrimmer.h"
+#include "BasicStackAllocator.h"
+
+IdleTrimmer::IdleTrimmer(std::chrono::milliseconds idleTime, std::chrono::milliseconds period) :
+	_idleTime(idleTime), _period(period), _stop(false)
+{
+	_worker = std::thread(&IdleTrimmer::work, this);
+}
+
+IdleTrimmer::~IdleTrimmer()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_stopped.notify_all();
+	_worker.join();
+}
+
+void IdleTrimmer::add(BasicStackAllocator * arena)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_arenas.push_back(arena);
+}
+
+void IdleTrimmer::remove(BasicStackAllocator * arena)
+{
+	std::lock_guard<std::mutex> lock(_mutex); //waits for a trim of arena in progress
+	auto it = std::find(_arenas.begin(), _arenas.end(), arena);
+	assert(it != _arenas.end());
+	if (it != _arenas.end())
+		_arenas.erase(it);
+}
+
+void IdleTrimmer::work()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (!_stopped.wait_for(lock, _period, [this]() { return _stop; })) {
+		auto idleSince = std::chrono::steady_clock::now() - _idleTime;
+		for (BasicStackAllocator* arena : _arenas)
+			arena->releaseUnusedIfIdle(idleSince);
+	}
+}
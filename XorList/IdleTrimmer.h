@@ -0,0 +1,33 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class BasicStackAllocator;
+
+//releases the spare blocks of arenas that took no new block and saw no reset for idleTime,
+//checking every period on a background thread
+class IdleTrimmer {
+public:
+	explicit IdleTrimmer(std::chrono::milliseconds idleTime,
+		std::chrono::milliseconds period = std::chrono::milliseconds(1000));
+	IdleTrimmer(const IdleTrimmer &) = delete;
+	IdleTrimmer& operator =(const IdleTrimmer &) = delete;
+	~IdleTrimmer();
+private:
+	friend class BasicStackAllocator;
+
+	std::chrono::milliseconds _idleTime, _period;
+	std::vector <BasicStackAllocator*> _arenas;
+	bool _stop;
+	std::mutex _mutex;
+	std::condition_variable _stopped;
+	std::thread _worker;
+
+	void add(BasicStackAllocator * arena);
+	void remove(BasicStackAllocator * arena);
+	void work();
+};
@@ -1,19 +1,131 @@
 #pragma once
 
+#include <assert.h>
 #include <list>
+#include <vector>
+#include <iterator>
+#include <utility>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
 
-std::random_device my_rand;
+//xoshiro256** seeded through splitmix64: cheap per number and fixed by its seed,
+//so that every generated workload can be generated again from the seed a report printed
+class OperationRandom {
+public:
+	typedef uint64_t result_type;
+
+	//streams of one seed are independent sequences, one per chunk of a parallel generation
+	explicit OperationRandom(uint64_t seed, uint64_t stream = 0);
+
+	uint64_t seed() const;
+
+	static constexpr uint64_t min() { return 0; }
+	static constexpr uint64_t max() { return UINT64_MAX; }
+	uint64_t operator()();
+	//uniform in [0, 1)
+	double unit();
+private:
+	uint64_t _seed;
+	uint64_t _state[4];
+
+	static uint64_t rotl(uint64_t value, int shift);
+};
+
+inline OperationRandom::OperationRandom(uint64_t seed, uint64_t stream) :
+	_seed(seed)
+{
+	uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ull);
+	for (uint64_t &word : _state) { //splitmix64
+		uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		word = z ^ (z >> 31);
+	}
+}
+
+inline uint64_t OperationRandom::seed() const
+{
+	return _seed;
+}
+
+inline uint64_t OperationRandom::operator()()
+{
+	uint64_t answer = rotl(_state[1] * 5, 7) * 9;
+	uint64_t t = _state[1] << 17;
+	_state[2] ^= _state[0];
+	_state[3] ^= _state[1];
+	_state[1] ^= _state[2];
+	_state[0] ^= _state[3];
+	_state[2] ^= t;
+	_state[3] = rotl(_state[3], 45);
+	return answer;
+}
+
+inline double OperationRandom::unit()
+{
+	return double((*this)() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+inline uint64_t OperationRandom::rotl(uint64_t value, int shift)
+{
+	return (value << shift) | (value >> (64 - shift));
+}
+
+//default values of the generated push_* operations
+template <typename T>
+T randomValue(OperationRandom &random) {
+	if constexpr (std::is_arithmetic<T>::value)
+		return T(random() >> 33); //non-negative for every integral T of 32 bits and more
+	else
+		return T();
+}
 
 //join two lists
 template <typename T>
 std::list<T>& join(std::list<T> &list1, std::list<T> &&list2) {
-	while (!list2.empty()) {
-		list1.push_back(list2.front());
-		list2.pop_front();
-	}
+	list1.splice(list1.end(), list2);
 	return list1;
 }
 
+//iterator at the position the last positional operation on a list left off, so that the next one walks from
+//there when that is shorter than from an end; valid for the list it was used with as long as that is only
+//changed by operations taking the cursor
+template <class List>
+class ListCursor {
+public:
+	ListCursor();
+
+	//iterator at position < list.size()
+	typename List::iterator at(List &list, size_t position);
+	void set(typename List::iterator it, size_t position);
+	void reset();
+private:
+	typename List::iterator _it;
+	size_t _position;
+	bool _valid;
+};
+
+//lists with insert_before(it, value) get it for inserting at a position, the others insert(it, value)
+template <class List, typename T, class = void>
+struct hasInsertBefore : std::false_type {};
+
+template <class List, typename T>
+struct hasInsertBefore<List, T, std::void_t<decltype(std::declval<List&>().insert_before(
+	std::declval<List&>().begin(), std::declval<const T&>()))>> : std::true_type {};
+
+//how operations on values of T act on a list of these elements: make(value) is the element pushed
+//for value, digest(element) the value a read of element answers with
+template <typename T>
+struct SameElement {
+	typedef T type;
+
+	static const T& make(const T &value) { return value; }
+	static const T& digest(const T &element) { return element; }
+};
 
 template <typename T>
 class ListOperation {
@@ -28,15 +140,31 @@ public:
 		LKfront,
 		LKget_by_iterator_from_begin,
 		LKget_by_iterator_from_end,
+		LKinsert_at,
+		LKerase_at,
+		LKmove_to_front,
 	};
+	static const size_t KIND_COUNT = size_t(LKmove_to_front) + 1;
+
 	ListOperation() = delete;
 	ListOperation(Kind kind, size_t size_t_value, const T& T_value);
 
+	Kind kind() const;
+	size_t size_t_value() const;
+	const T& T_value() const;
+	static const char * kindName(Kind kind);
+
 	static size_t last_size_t_answer();
 	static T last_T_answer();
 
 	template <class List>
-	void operator()(List& list);
+	void operator()(List& list) const;
+	//positional operations walk from where the previous ones on list left cursor
+	template <class List>
+	void operator()(List& list, ListCursor<List> &cursor) const;
+	//on a list of Element::type, like SameElement<T> for operator()
+	template <class Element, class List>
+	void apply(List& list, ListCursor<List> &cursor) const;
 private:
 	Kind _kind;
 	size_t _size_t_value;
@@ -46,14 +174,12 @@ private:
 	static T _last_T_answer;
 	static void discardStatic();
 
+	template <class Element, class List>
+	void _insert_at(List &list, ListCursor<List> &cursor) const;
 	template <class List>
-	static typename List::iterator _get_iterator_from_begin(List &list, size_t pos);
-	//including begin
-
-	template <class List>
-	static typename List::iterator _get_iterator_from_end(List &list, size_t pos);
-	//excluding end
-
+	void _erase_at(List &list, ListCursor<List> &cursor) const;
+	template <class Element, class List>
+	void _move_to_front(List &list, ListCursor<List> &cursor) const;
 };
 
 template<typename T>
@@ -63,29 +189,71 @@ template<typename T>
 T ListOperation<T>::_last_T_answer;
 
 
-template<typename T>
 template<class List>
-typename List::iterator ListOperation<T>::_get_iterator_from_begin(List &list, size_t pos)
+ListCursor<List>::ListCursor() :
+	_position(0), _valid(false)
 {
-	typename List::iterator it = list.begin();
-	for (size_t i = 0; i < pos; ++i)
-		it++;
-	return it;
+	//initialize values
+}
+
+template<class List>
+typename List::iterator ListCursor<List>::at(List & list, size_t position)
+{
+	size_t fromBegin = position, fromEnd = list.size() - position;
+	size_t fromCursor = !_valid ? SIZE_MAX : position > _position ? position - _position : _position - position;
+	if (fromCursor <= fromBegin && fromCursor <= fromEnd) {
+		for (; _position < position; _position++)
+			++_it;
+		for (; _position > position; _position--)
+			--_it;
+	}
+	else if (fromBegin <= fromEnd) {
+		_it = list.begin();
+		for (size_t i = 0; i < fromBegin; ++i)
+			++_it;
+	}
+	else {
+		_it = list.end();
+		for (size_t i = 0; i < fromEnd; ++i)
+			--_it;
+	}
+	_position = position;
+	_valid = true;
+	return _it;
+}
+
+template<class List>
+void ListCursor<List>::set(typename List::iterator it, size_t position)
+{
+	_it = it;
+	_position = position;
+	_valid = true;
+}
+
+template<class List>
+void ListCursor<List>::reset()
+{
+	_valid = false;
 }
 
 template<typename T>
 template<class List>
-typename List::iterator ListOperation<T>::_get_iterator_from_end(List &list, size_t pos)
+void ListOperation<T>::operator()(List & list) const
 {
-	typename List::iterator it = list.end();
-	for (size_t i = 0; i <= pos; ++i)
-		it--;
-	return it;
+	ListCursor<List> cursor;
+	(*this)(list, cursor);
 }
 
 template<typename T>
 template<class List>
-void ListOperation<T>::operator()(List & list)
+void ListOperation<T>::operator()(List & list, ListCursor<List> &cursor) const
+{
+	apply<SameElement<T> >(list, cursor);
+}
+
+template<typename T>
+template<class Element, class List>
+void ListOperation<T>::apply(List & list, ListCursor<List> &cursor) const
 {
 	switch (_kind)
 	{
@@ -93,48 +261,116 @@ void ListOperation<T>::operator()(List & list)
 		_last_size_t_answer = list.size();
 		break;
 	case LKpush_back:
-		list.push_back(_T_value);
+		list.push_back(Element::make(_T_value));
+		cursor.reset();
 		break;
 	case LKpush_front:
-		list.push_front(_T_value);
+		list.push_front(Element::make(_T_value));
+		cursor.reset();
 		break;
 	case LKpop_back:
 		list.pop_back();
+		cursor.reset();
 		break;
 	case LKpop_front:
 		list.pop_front();
+		cursor.reset();
 		break;
 	case LKback:
-		_last_T_answer = list.back();
+		_last_T_answer = Element::digest(list.back());
+		break;
+	case LKfront:
+		_last_T_answer = Element::digest(list.front());
 		break;
 	case LKget_by_iterator_from_begin:
-		_last_T_answer = *_get_iterator_from_begin<List>(list, _size_t_value);
+		_last_T_answer = Element::digest(*cursor.at(list, _size_t_value));
 		break;
 	case LKget_by_iterator_from_end:
-		_last_T_answer = *_get_iterator_from_end<List>(list, _size_t_value);
+		_last_T_answer = Element::digest(*cursor.at(list, list.size() - 1 - _size_t_value));
+		break;
+	case LKinsert_at:
+		_insert_at<Element>(list, cursor);
+		break;
+	case LKerase_at:
+		_erase_at(list, cursor);
+		break;
+	case LKmove_to_front:
+		_move_to_front<Element>(list, cursor);
 		break;
 	default:
 		break;
 	}
 }
 
-template <typename T, T generate()>
-ListOperation <T> generate_random_insertion_operation() {
-	int id = my_rand() % 2;
+//the cursor is left on the element before the changed position: an iterator of a XorList
+//knows its previous node, so only that one stays valid over the change
+template<typename T>
+template<class Element, class List>
+void ListOperation<T>::_insert_at(List & list, ListCursor<List> &cursor) const
+{
+	if (_size_t_value == 0 || _size_t_value == list.size()) {
+		if (_size_t_value == 0)
+			list.push_front(Element::make(_T_value));
+		else
+			list.push_back(Element::make(_T_value));
+		cursor.reset();
+		return;
+	}
+	typename List::iterator it = cursor.at(list, _size_t_value), previous = it;
+	--previous;
+	if constexpr (hasInsertBefore<List, typename Element::type>::value)
+		list.insert_before(it, Element::make(_T_value));
+	else
+		list.insert(it, Element::make(_T_value));
+	cursor.set(previous, _size_t_value - 1);
+}
+
+template<typename T>
+template<class List>
+void ListOperation<T>::_erase_at(List & list, ListCursor<List> &cursor) const
+{
+	typename List::iterator it = cursor.at(list, _size_t_value), previous = it;
+	if (_size_t_value == 0) {
+		list.erase(it);
+		cursor.reset();
+		return;
+	}
+	--previous;
+	list.erase(it);
+	cursor.set(previous, _size_t_value - 1);
+}
+
+template<typename T>
+template<class Element, class List>
+void ListOperation<T>::_move_to_front(List & list, ListCursor<List> &cursor) const
+{
+	typename List::iterator it = cursor.at(list, _size_t_value);
+	_last_T_answer = Element::digest(*it);
+	if (_size_t_value != 0) {
+		typename Element::type element = std::move(*it);
+		list.erase(it);
+		list.push_front(std::move(element));
+	}
+	cursor.reset();
+}
+
+template <typename T, T generate(OperationRandom&)>
+ListOperation <T> generate_random_insertion_operation(OperationRandom &random) {
+	int id = random() % 2;
 	switch (id)
 	{
 	case 0:
-		return ListOperation<T>(ListOperation<T>::Kind::LKpush_back, 0, generate());
+		return ListOperation<T>(ListOperation<T>::Kind::LKpush_back, 0, generate(random));
 	case 1:
-		return ListOperation<T>(ListOperation<T>::Kind::LKpush_front, 0, generate());
+		return ListOperation<T>(ListOperation<T>::Kind::LKpush_front, 0, generate(random));
 	default:
 		break;
 	}
 }
 
 template <typename T>
-ListOperation <T> generate_random_erase_operation() {
-	int id = my_rand() % 2;
+ListOperation <T> generate_random_erase_operation(OperationRandom &random) {
+	int id = random() % 2;
 	switch (id)
 	{
 	case 0:
@@ -145,8 +381,8 @@ ListOperation <T> generate_random_erase_operation() {
 }
 
 template <typename T>
-ListOperation <T> generate_random_access_operation(size_t size) {
-	int id = my_rand() % 5;
+ListOperation <T> generate_random_access_operation(size_t size, OperationRandom &random) {
+	int id = random() % 5;
 	switch (id)
 	{
 	case 0:
@@ -187,38 +423,119 @@ std::pair <int, int> generationFlagBourders(GenerationFlag flag) {
 	}
 }
 
-template <typename T, T generate() = T()>
-std::list <ListOperation<T> > generate_operation_list(
-	size_t number, size_t& size, GenerationFlag flag = GFno_specification) {
-	std::list<ListOperation<T> > answer;
-	const int MAX_SIZE = 30000;
-	for (size_t i = 0; i < number; i++) {
-		if (size == 0) {
-			size++;
-			answer.push_back(generate_random_insertion_operation<T, generate>());
-			continue;
-		}
-		if (size == MAX_SIZE) {
-			size--;
-			answer.push_back(generate_random_erase_operation<T>());
-			continue;
-		}
-		int op_id = my_rand() % 6;
+//size the generated operations never let a list grow beyond
+const size_t GENERATION_MAX_SIZE = 30000;
+
+//the next operation on a list of size elements, which it updates
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+ListOperation <T> generate_operation(size_t& size, OperationRandom &random, GenerationFlag flag = GFno_specification) {
+	const size_t MAX_SIZE = GENERATION_MAX_SIZE;
+	if (size == 0) {
+		size++;
+		return generate_random_insertion_operation<T, generate>(random);
+	}
+	if (size == MAX_SIZE) {
+		size--;
+		return generate_random_erase_operation<T>(random);
+	}
+	int op_id = random() % 6;
+	std::pair <int, int> bourders = generationFlagBourders(flag);
+	if (op_id < bourders.first) {
+		size++;
+		return generate_random_insertion_operation<T, generate>(random);
+	}
+	else if (op_id < bourders.second) {
+		size--;
+		return generate_random_erase_operation<T>(random);
+	}
+	else
+		return generate_random_access_operation<T>(size, random);
+}
+
+//draws what generate_operation does and updates size the same way, without building the operation;
+//the value of an insertion is still generated, as the draws of the next operation follow its draws
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+void skip_operation(size_t& size, OperationRandom &random, GenerationFlag flag = GFno_specification) {
+	bool insertion = size == 0, erase = size == GENERATION_MAX_SIZE;
+	if (!insertion && !erase) {
+		int op_id = random() % 6;
 		std::pair <int, int> bourders = generationFlagBourders(flag);
-		if (op_id < bourders.first) {
-			answer.push_back(generate_random_insertion_operation<T, generate>());
-			size++;
-		}
-		else if (op_id < bourders.second) {
-			answer.push_back(generate_random_erase_operation<T>());
-			size--;
-		}
-		else
-			answer.push_back(generate_random_access_operation<T>(size));
+		insertion = op_id < bourders.first;
+		erase = !insertion && op_id < bourders.second;
 	}
+	random(); //which end, or which access
+	if (insertion) {
+		generate(random);
+		size++;
+	}
+	else if (erase)
+		size--;
+}
+
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+std::list <ListOperation<T> > generate_operation_list(
+	size_t number, size_t& size, OperationRandom &random, GenerationFlag flag = GFno_specification) {
+	std::list<ListOperation<T> > answer;
+	for (size_t i = 0; i < number; i++)
+		answer.push_back(generate_operation<T, generate>(size, random, flag));
 	return answer;
 }
 
+//single pass over the operations Stream::next() draws until Stream::done()
+template <typename T, class Stream>
+class OperationStreamIterator {
+public:
+	using iterator_category = std::input_iterator_tag;
+	using value_type = ListOperation<T>;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const ListOperation<T> *;
+	using reference = const ListOperation<T> &;
+
+	//the end if stream is nullptr
+	explicit OperationStreamIterator(Stream * stream);
+	const ListOperation<T>& operator *() const;
+	const ListOperation<T>* operator ->() const;
+	OperationStreamIterator& operator ++();
+	bool operator ==(const OperationStreamIterator &other) const;
+	bool operator !=(const OperationStreamIterator &other) const;
+private:
+	Stream * _stream; //nullptr once past the last operation
+	ListOperation<T> _op;
+};
+
+//the operations of phases of generate_operation_list, drawn one at a time as they are consumed instead of
+//kept in a list: a single pass, and random has to outlive the stream
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+class OperationStream {
+public:
+	struct Phase {
+		size_t number;
+		GenerationFlag flag;
+	};
+	typedef OperationStreamIterator<T, OperationStream> iterator;
+
+	//the operations start on a list of size elements
+	OperationStream(std::vector<Phase> phases, OperationRandom &random, size_t size = 0);
+
+	bool done() const;
+	size_t remaining() const;
+	//of the list after the operations drawn so far
+	size_t size() const;
+	ListOperation<T> next();
+	//advances past the operation next() would return, see skip_operation
+	void skip();
+
+	iterator begin();
+	iterator end();
+private:
+	std::vector<Phase> _phases;
+	size_t _phase;
+	size_t _inPhase; //operations already drawn in _phases[_phase]
+	size_t _remaining;
+	size_t _size;
+	OperationRandom * _random;
+};
+
 template<typename T>
 ListOperation<T>::ListOperation(Kind kind, size_t size_t_value, const T & T_value) :
 	_kind(kind), _size_t_value(size_t_value), _T_value(T_value)
@@ -226,6 +543,44 @@ ListOperation<T>::ListOperation(Kind kind, size_t size_t_value, const T & T_valu
 	//initialize values;
 }
 
+template<typename T>
+typename ListOperation<T>::Kind ListOperation<T>::kind() const
+{
+	return _kind;
+}
+
+template<typename T>
+size_t ListOperation<T>::size_t_value() const
+{
+	return _size_t_value;
+}
+
+template<typename T>
+const T & ListOperation<T>::T_value() const
+{
+	return _T_value;
+}
+
+template<typename T>
+const char * ListOperation<T>::kindName(Kind kind)
+{
+	static const char * const names[KIND_COUNT] = {
+		"size",
+		"push_back",
+		"push_front",
+		"pop_back",
+		"pop_front",
+		"back",
+		"front",
+		"get_by_iterator_from_begin",
+		"get_by_iterator_from_end",
+		"insert_at",
+		"erase_at",
+		"move_to_front",
+	};
+	return names[kind];
+}
+
 template<typename T>
 size_t ListOperation<T>::last_size_t_answer()
 {
@@ -245,58 +600,143 @@ void ListOperation<T>::discardStatic()
 	_last_T_answer = T();
 }
 
-template <typename T, class List1, class List2>
-void doOperationAndCheck(
-	List1 &list1, List2 &list2, ListOperation<T> &op) {
-	size_t size_t_answer1, size_t_answer2;
-	T T_answer1, T_answer2;
-	op(list1);
-	size_t_answer1 = ListOperation<T>::last_size_t_answer();
-	T_answer1 = ListOperation<T>::last_T_answer();
-	op(list2);
-	size_t_answer2 = ListOperation<T>::last_size_t_answer();
-	T_answer2 = ListOperation<T>::last_T_answer();
-	ASSERT_EQ(size_t_answer1, size_t_answer2);
-	ASSERT_EQ(T_answer1, T_answer2);
+//opList is a list of operations or an OperationStream
+template <class List1, class Operations>
+void doOperations(List1 &list, Operations &&opList) {
+	ListCursor<List1> cursor;
+	for (const auto &op : opList)
+		op(list, cursor);
 }
 
-template <typename T, class List1>
-void doOperations(List1 &list, const std::list<ListOperation<T> > &opList) {
-	for (auto op : opList)
-		op(list);
+template<typename T, T generate(OperationRandom&)>
+OperationStream<T, generate>::OperationStream(std::vector<Phase> phases, OperationRandom & random, size_t size) :
+	_phases(std::move(phases)), _phase(0), _inPhase(0), _remaining(0), _size(size), _random(&random)
+{
+	for (const Phase &phase : _phases)
+		_remaining += phase.number;
 }
 
+template<typename T, T generate(OperationRandom&)>
+bool OperationStream<T, generate>::done() const
+{
+	return _remaining == 0;
+}
 
-template <typename T, T generate() = T()>
-std::list<ListOperation<T> > generateRandomLeapOperations(size_t num) {
-	std::list<ListOperation<T> > answer;
-	size_t size = 0;
-	answer = join(answer, generate_operation_list<T, generate>(num / 4, size, GFcreate));
-	answer = join(answer, generate_operation_list<T, generate>(num / 4, size, GFno_specification));
-	answer = join(answer, generate_operation_list<T, generate>(num / 4, size, GFfree));
-	answer = join(answer, generate_operation_list<T, generate>(num - 3 * (num / 4), size, GFaccess));
-	return answer;
+template<typename T, T generate(OperationRandom&)>
+size_t OperationStream<T, generate>::remaining() const
+{
+	return _remaining;
+}
 
+template<typename T, T generate(OperationRandom&)>
+size_t OperationStream<T, generate>::size() const
+{
+	return _size;
 }
 
-template <typename T, T generate() = T()>
-std::list<ListOperation<T> > generateRandomStaticOperations(size_t num) {
-	std::list<ListOperation<T> > answer;
-	size_t size = 0;
-	answer = join(answer, generate_operation_list<T, generate>(num / 10, size, GFcreate));
-	answer = join(answer, generate_operation_list<T, generate>(num - (num / 10), size, GFno_specification));
-	return answer;
+template<typename T, T generate(OperationRandom&)>
+ListOperation<T> OperationStream<T, generate>::next()
+{
+	assert(!done());
+	while (_inPhase == _phases[_phase].number) {
+		_phase++;
+		_inPhase = 0;
+	}
+	_inPhase++;
+	_remaining--;
+	return generate_operation<T, generate>(_size, *_random, _phases[_phase].flag);
 }
 
-template <typename T, T generate() = T()>
-std::list<ListOperation<T> > generateRandomLadderOperations(size_t num) {
-	std::list<ListOperation<T> > answer;
+template<typename T, T generate(OperationRandom&)>
+void OperationStream<T, generate>::skip()
+{
+	assert(!done());
+	while (_inPhase == _phases[_phase].number) {
+		_phase++;
+		_inPhase = 0;
+	}
+	_inPhase++;
+	_remaining--;
+	skip_operation<T, generate>(_size, *_random, _phases[_phase].flag);
+}
+
+template<typename T, T generate(OperationRandom&)>
+typename OperationStream<T, generate>::iterator OperationStream<T, generate>::begin()
+{
+	return iterator(this);
+}
+
+template<typename T, T generate(OperationRandom&)>
+typename OperationStream<T, generate>::iterator OperationStream<T, generate>::end()
+{
+	return iterator(nullptr);
+}
+
+template<typename T, class Stream>
+OperationStreamIterator<T, Stream>::OperationStreamIterator(Stream * stream) :
+	_stream(stream), _op(ListOperation<T>::LKsize, 0, T())
+{
+	++*this;
+}
+
+template<typename T, class Stream>
+const ListOperation<T>& OperationStreamIterator<T, Stream>::operator*() const
+{
+	return _op;
+}
+
+template<typename T, class Stream>
+const ListOperation<T>* OperationStreamIterator<T, Stream>::operator->() const
+{
+	return &_op;
+}
+
+template<typename T, class Stream>
+OperationStreamIterator<T, Stream> & OperationStreamIterator<T, Stream>::operator++()
+{
+	if (_stream != nullptr && _stream->done())
+		_stream = nullptr;
+	if (_stream != nullptr)
+		_op = _stream->next();
+	return *this;
+}
+
+template<typename T, class Stream>
+bool OperationStreamIterator<T, Stream>::operator==(const OperationStreamIterator & other) const
+{
+	return _stream == other._stream;
+}
+
+template<typename T, class Stream>
+bool OperationStreamIterator<T, Stream>::operator!=(const OperationStreamIterator & other) const
+{
+	return _stream != other._stream;
+}
+
+
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+OperationStream<T, generate> streamRandomLeapOperations(size_t num, OperationRandom &random) {
+	return OperationStream<T, generate>({ { num / 4, GFcreate }, { num / 4, GFno_specification },
+		{ num / 4, GFfree }, { num - 3 * (num / 4), GFaccess } }, random);
+}
+
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+std::vector<typename OperationStream<T, generate>::Phase> randomStaticPhases(size_t num) {
+	return { { num / 10, GFcreate }, { num - (num / 10), GFno_specification } };
+}
+
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+OperationStream<T, generate> streamRandomStaticOperations(size_t num, OperationRandom &random) {
+	return OperationStream<T, generate>(randomStaticPhases<T, generate>(num), random);
+}
+
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+OperationStream<T, generate> streamRandomLadderOperations(size_t num, OperationRandom &random) {
 	const size_t LEAP_OPERATION_COUNT = 3000;
+	std::vector<typename OperationStream<T, generate>::Phase> phases;
 	auto kind = GFcreate;
-	size_t size = 0;
 	while (true) {
-		answer = join(answer, generate_operation_list<T, generate>(
-			std::min(num, LEAP_OPERATION_COUNT), size, kind));
+		phases.push_back({ std::min(num, LEAP_OPERATION_COUNT), kind });
 		if (kind == GFcreate)
 			kind = GFfree;
 		else
@@ -305,5 +745,382 @@ std::list<ListOperation<T> > generateRandomLadderOperations(size_t num) {
 			break;
 		num -= LEAP_OPERATION_COUNT;
 	}
+	return OperationStream<T, generate>(std::move(phases), random);
+}
+
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+std::list<ListOperation<T> > generateRandomLeapOperations(size_t num, OperationRandom &random) {
+	auto stream = streamRandomLeapOperations<T, generate>(num, random);
+	return std::list<ListOperation<T> >(stream.begin(), stream.end());
+}
+
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+std::list<ListOperation<T> > generateRandomStaticOperations(size_t num, OperationRandom &random) {
+	auto stream = streamRandomStaticOperations<T, generate>(num, random);
+	return std::list<ListOperation<T> >(stream.begin(), stream.end());
+}
+
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+std::list<ListOperation<T> > generateRandomLadderOperations(size_t num, OperationRandom &random) {
+	auto stream = streamRandomLadderOperations<T, generate>(num, random);
+	return std::list<ListOperation<T> >(stream.begin(), stream.end());
+}
+
+//operations per chunk of generateInChunks, fixed so that a seed gives the same operations for any number of threads
+const size_t GENERATION_CHUNK = size_t(1) << 16;
+
+//the count operations of phases from operation first on
+template <class Phase>
+std::vector<Phase> slicePhases(const std::vector<Phase> &phases, size_t first, size_t count) {
+	std::vector<Phase> answer;
+	for (const Phase &phase : phases) {
+		if (count == 0)
+			break;
+		if (first >= phase.number) {
+			first -= phase.number;
+			continue;
+		}
+		size_t number = std::min(phase.number - first, count);
+		answer.push_back({ number, phase.flag });
+		count -= number;
+		first = 0;
+	}
 	return answer;
-}
\ No newline at end of file
+}
+
+//generateChunk(stream) of the chunks of GENERATION_CHUNK operations phases split into, in order, each drawn
+//from a stream of seed of its own and run on one of threads (the hardware ones if 0). A chunk starts on the
+//list the chunks before it leave, so the phases and size limits hold over all of them as in a single stream:
+//a first pass skips through the chunks one after another only to learn the size each one starts from
+template <class Chunk, typename T, T generate(OperationRandom&) = randomValue<T>, class ChunkGenerator>
+std::vector<Chunk> generateChunks(const std::vector<typename OperationStream<T, generate>::Phase> &phases,
+	uint64_t seed, ChunkGenerator generateChunk, size_t threads = 0) {
+	size_t num = 0;
+	for (const auto &phase : phases)
+		num += phase.number;
+	size_t chunks = (num + GENERATION_CHUNK - 1) / GENERATION_CHUNK;
+	std::vector<size_t> startSizes(chunks);
+	size_t size = 0;
+	for (size_t chunk = 0; chunk < chunks; chunk++) {
+		startSizes[chunk] = size;
+		OperationRandom random(seed, chunk);
+		OperationStream<T, generate> stream(slicePhases(phases, chunk * GENERATION_CHUNK, GENERATION_CHUNK), random, size);
+		while (!stream.done())
+			stream.skip();
+		size = stream.size();
+	}
+	std::vector<Chunk> parts(chunks);
+	std::atomic<size_t> nextChunk(0);
+	auto work = [&]() {
+		for (size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+			OperationRandom random(seed, chunk);
+			OperationStream<T, generate> stream(
+				slicePhases(phases, chunk * GENERATION_CHUNK, GENERATION_CHUNK), random, startSizes[chunk]);
+			parts[chunk] = generateChunk(stream);
+		}
+	};
+	if (threads == 0)
+		threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	std::vector<std::thread> workers;
+	for (size_t i = 1; i < std::min(threads, chunks); i++)
+		workers.emplace_back(work);
+	work();
+	for (auto &worker : workers)
+		worker.join();
+	return parts;
+}
+
+//the operations of generateChunks concatenated
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+std::list<ListOperation<T> > generateInChunks(const std::vector<typename OperationStream<T, generate>::Phase> &phases,
+	uint64_t seed, size_t threads = 0) {
+	std::list<ListOperation<T> > answer;
+	for (auto &part : generateChunks<std::list<ListOperation<T> >, T, generate>(phases, seed,
+		[](OperationStream<T, generate> &stream) {
+			return std::list<ListOperation<T> >(stream.begin(), stream.end());
+		}, threads))
+		answer.splice(answer.end(), part);
+	return answer;
+}
+
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+std::list<ListOperation<T> > generateRandomStaticOperationsInChunks(size_t num, uint64_t seed, size_t threads = 0) {
+	return generateInChunks<T, generate>(randomStaticPhases<T, generate>(num), seed, threads);
+}
+
+//ranks 1..n with probability proportional to rank^-exponent, drawn in constant time by rejection-inversion
+//(Hormann and Derflinger), so that even 10^8 keys need no table
+class ZipfDistribution {
+public:
+	ZipfDistribution(uint64_t n, double exponent);
+
+	uint64_t operator()(OperationRandom &random) const;
+private:
+	uint64_t _n;
+	double _exponent;
+	double _hIntegralX1;
+	double _hIntegralN;
+	double _s;
+
+	double h(double x) const;
+	double hIntegral(double x) const;
+	double hIntegralInverse(double x) const;
+	static double helper1(double x); //log1p(x) / x, also near 0
+	static double helper2(double x); //expm1(x) / x, also near 0
+};
+
+inline ZipfDistribution::ZipfDistribution(uint64_t n, double exponent) :
+	_n(std::max<uint64_t>(n, 1)), _exponent(exponent)
+{
+	_hIntegralX1 = hIntegral(1.5) - 1;
+	_hIntegralN = hIntegral(double(_n) + 0.5);
+	_s = 2 - hIntegralInverse(hIntegral(2.5) - h(2));
+}
+
+inline uint64_t ZipfDistribution::operator()(OperationRandom & random) const
+{
+	while (true) {
+		double u = _hIntegralN + random.unit() * (_hIntegralX1 - _hIntegralN);
+		double x = hIntegralInverse(u);
+		double k = std::min(std::max(std::floor(x + 0.5), 1.0), double(_n));
+		if (k - x <= _s || u >= hIntegral(k + 0.5) - h(k))
+			return uint64_t(k);
+	}
+}
+
+inline double ZipfDistribution::h(double x) const
+{
+	return std::exp(-_exponent * std::log(x));
+}
+
+inline double ZipfDistribution::hIntegral(double x) const
+{
+	double logX = std::log(x);
+	return helper2((1 - _exponent) * logX) * logX;
+}
+
+inline double ZipfDistribution::hIntegralInverse(double x) const
+{
+	double t = std::max(x * (1 - _exponent), -1.0);
+	return std::exp(helper1(t) * x);
+}
+
+inline double ZipfDistribution::helper1(double x)
+{
+	if (std::abs(x) > 1e-8)
+		return std::log1p(x) / x;
+	return 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+}
+
+inline double ZipfDistribution::helper2(double x)
+{
+	if (std::abs(x) > 1e-8)
+		return std::expm1(x) / x;
+	return 1 + x * 0.5 * (1 + x * (1.0 / 3) * (1 + 0.25 * x));
+}
+
+enum WorkloadProfile {
+	WPfifo,
+	WPlifo,
+	WPlru,
+	WPsliding_window,
+	WPcursor,
+};
+const size_t WORKLOAD_PROFILE_COUNT = size_t(WPcursor) + 1;
+
+inline const char * workloadProfileName(WorkloadProfile profile) {
+	static const char * const names[WORKLOAD_PROFILE_COUNT] = {
+		"fifo",
+		"lifo",
+		"lru",
+		"sliding_window",
+		"cursor",
+	};
+	return names[profile];
+}
+
+struct WorkloadParameters {
+	WorkloadProfile profile = WPfifo;
+	//elements the profile works around, pushed back by its first operations
+	size_t size = 1000000;
+	//of the keys LRU touches, 2 * size of them: ranks beyond the list are misses
+	double zipfExponent = 0.99;
+	//LRU hits deeper than this are moved from this position instead, 0 for no limit: an LRU finds the element
+	//through an index, so the walk to it is not part of the workload, and at millions of elements it would
+	//make up all of it. The hit rate stays that of the whole key space
+	size_t lruMaxRank = 256;
+	//sliding window reads among this many newest elements
+	size_t windowReads = 64;
+	//the mid-list cursor moves by at most this many elements between operations
+	size_t cursorStep = 16;
+};
+
+//num operations of a workload profile after the size push_backs filling the list, drawn one at a time
+//as they are consumed like OperationStream:
+//FIFO queue: push_back and pop_front, with peeks at the front, as a random walk between empty and twice size
+//LIFO stack: the same at the back
+//LRU: touches of Zipfian keys; a key of rank k is about k-th in recency order, so a hit moves the element
+//at that position (at most lruMaxRank) to the front, and a miss pushes a new one in front and evicts the back
+//once over size
+//sliding window: push_back of the newest, pop_front of the oldest over size, reads among the newest
+//cursor: insert_at, erase_at and reads at a cursor moving a few elements between them
+template <typename T, T generate(OperationRandom&) = randomValue<T>>
+class ProfileStream {
+public:
+	typedef OperationStreamIterator<T, ProfileStream> iterator;
+
+	ProfileStream(const WorkloadParameters &parameters, size_t num, OperationRandom &random);
+
+	//for a caller filling the list itself: the next operation is the first one after the fill
+	void skipFill();
+	bool done() const;
+	size_t remaining() const;
+	ListOperation<T> next();
+
+	iterator begin();
+	iterator end();
+private:
+	WorkloadParameters _parameters;
+	ZipfDistribution _keys;
+	size_t _fill; //push_backs left of it
+	size_t _remaining; //including _fill
+	size_t _size;
+	size_t _cursor;
+	bool _evict; //a pop_back after an LRU miss is due
+	OperationRandom * _random;
+
+	ListOperation<T> nextOfProfile();
+};
+
+template<typename T, T generate(OperationRandom&)>
+ProfileStream<T, generate>::ProfileStream(const WorkloadParameters & parameters, size_t num, OperationRandom & random) :
+	_parameters(parameters), _keys(2 * std::max<uint64_t>(parameters.size, 1), parameters.zipfExponent),
+	_fill(std::max<size_t>(parameters.size, 1)), _remaining(_fill + num), _size(0), _cursor(0), _evict(false),
+	_random(&random)
+{
+	_parameters.size = _fill;
+	_parameters.windowReads = std::max<size_t>(_parameters.windowReads, 1);
+	if (_parameters.lruMaxRank == 0)
+		_parameters.lruMaxRank = SIZE_MAX;
+}
+
+template<typename T, T generate(OperationRandom&)>
+void ProfileStream<T, generate>::skipFill()
+{
+	_remaining -= _fill;
+	_size += _fill;
+	_fill = 0;
+}
+
+template<typename T, T generate(OperationRandom&)>
+bool ProfileStream<T, generate>::done() const
+{
+	return _remaining == 0;
+}
+
+template<typename T, T generate(OperationRandom&)>
+size_t ProfileStream<T, generate>::remaining() const
+{
+	return _remaining;
+}
+
+template<typename T, T generate(OperationRandom&)>
+ListOperation<T> ProfileStream<T, generate>::next()
+{
+	assert(!done());
+	_remaining--;
+	if (_fill == 0)
+		return nextOfProfile();
+	_fill--;
+	_size++;
+	return ListOperation<T>(ListOperation<T>::LKpush_back, 0, generate(*_random));
+}
+
+template<typename T, T generate(OperationRandom&)>
+typename ProfileStream<T, generate>::iterator ProfileStream<T, generate>::begin()
+{
+	return iterator(this);
+}
+
+template<typename T, T generate(OperationRandom&)>
+typename ProfileStream<T, generate>::iterator ProfileStream<T, generate>::end()
+{
+	return iterator(nullptr);
+}
+
+template<typename T, T generate(OperationRandom&)>
+ListOperation<T> ProfileStream<T, generate>::nextOfProfile()
+{
+	typedef ListOperation<T> Op;
+	OperationRandom &random = *_random;
+	const size_t size = _parameters.size;
+	switch (_parameters.profile)
+	{
+	case WPfifo:
+	case WPlifo: {
+		bool fifo = _parameters.profile == WPfifo;
+		size_t id = _size == 0 ? 0 : _size >= 2 * size ? 9 : size_t(random() % 20);
+		if (id < 9) {
+			_size++;
+			return Op(Op::LKpush_back, 0, generate(random));
+		}
+		if (id < 18) {
+			_size--;
+			return Op(fifo ? Op::LKpop_front : Op::LKpop_back, 0, T());
+		}
+		return Op(fifo ? Op::LKfront : Op::LKback, 0, T());
+	}
+	case WPlru: {
+		if (_evict) {
+			_evict = false;
+			_size--;
+			return Op(Op::LKpop_back, 0, T());
+		}
+		uint64_t rank = _keys(random) - 1;
+		if (rank < _size)
+			return Op(Op::LKmove_to_front, size_t(std::min<uint64_t>(rank, _parameters.lruMaxRank)), T());
+		_size++;
+		_evict = _size > size;
+		return Op(Op::LKpush_front, 0, generate(random));
+	}
+	case WPsliding_window:
+		if (_size > size) {
+			_size--;
+			return Op(Op::LKpop_front, 0, T());
+		}
+		if (_size == 0 || random() % 2 == 0) {
+			_size++;
+			return Op(Op::LKpush_back, 0, generate(random));
+		}
+		return Op(Op::LKget_by_iterator_from_end, size_t(random() % std::min(_size, _parameters.windowReads)), T());
+	case WPcursor: {
+		if (_size == 0) {
+			_cursor = 0;
+			_size++;
+			return Op(Op::LKinsert_at, 0, generate(random));
+		}
+		size_t step = _parameters.cursorStep;
+		size_t move = size_t(random() % (2 * step + 1));
+		if (move < step)
+			_cursor -= std::min(_cursor, step - move);
+		else
+			_cursor = std::min(_cursor + (move - step), _size - 1);
+		size_t id = _size < size / 2 ? 0 : _size > 2 * size ? 2 : size_t(random() % 5);
+		if (id < 2) {
+			_size++;
+			return Op(Op::LKinsert_at, _cursor, generate(random));
+		}
+		if (id < 4) {
+			Op answer(Op::LKerase_at, _cursor, T());
+			_size--;
+			if (_cursor == _size && _cursor != 0)
+				_cursor--;
+			return answer;
+		}
+		return Op(Op::LKget_by_iterator_from_begin, _cursor, T());
+	}
+	default:
+		break;
+	}
+	return Op(Op::LKsize, 0, T());
+}
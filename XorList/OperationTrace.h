@@ -0,0 +1,407 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+#include "ListOperation.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+//binary format of a sequence of ListOperation<T>: the magic "XLOT", a version byte and sizeof(T),
+//then per operation a kind byte followed by the operands that kind uses: a varint position for
+//get_by_iterator_*, insert_at, erase_at and move_to_front, then the value for push_* and insert_at
+//(a zigzag varint for integral T, the raw bytes otherwise). Version 1 has no insert_at, erase_at
+//and move_to_front, version 2 added them; both are read
+namespace OperationTraceFormat {
+	const char MAGIC[4] = { 'X', 'L', 'O', 'T' };
+	const unsigned char VERSION = 2;
+	const unsigned char FIRST_VERSION = 1;
+	const size_t HEADER_SIZE = sizeof(MAGIC) + 2;
+	//of a uint64_t, 7 bits per byte
+	const size_t MAX_VARINT_SIZE = 10;
+}
+
+//read-only view of a whole file, mapped into memory
+class MappedFile {
+public:
+	//throws std::runtime_error if path can not be opened or mapped
+	explicit MappedFile(const std::string &path);
+	MappedFile(const MappedFile &) = delete;
+	MappedFile& operator =(const MappedFile &) = delete;
+	~MappedFile();
+
+	const char * data() const;
+	size_t size() const;
+private:
+	const char * _data;
+	size_t _size;
+#if defined(_WIN32)
+	HANDLE _file;
+	HANDLE _mapping;
+#endif
+};
+
+//appends the trace format of operations to out, through a buffer flushed every FLUSH_SIZE bytes
+//and on destruction
+template <typename T>
+class OperationTraceWriter {
+public:
+	static const size_t FLUSH_SIZE = size_t(1) << 16;
+
+	explicit OperationTraceWriter(std::ostream &out);
+	OperationTraceWriter(const OperationTraceWriter &) = delete;
+	OperationTraceWriter& operator =(const OperationTraceWriter &) = delete;
+	~OperationTraceWriter();
+
+	void write(const ListOperation<T> &op);
+	//ops is a container of operations or an OperationStream
+	template <class Operations>
+	void writeAll(Operations &&ops);
+	void flush();
+private:
+	std::ostream * _out;
+	std::string _buffer;
+
+	void writeVarint(uint64_t value);
+};
+
+//operations decoded on the fly from a trace in memory: iterating or replaying it allocates nothing;
+//reaching an unknown kind, an overlong varint or a truncated operation throws std::runtime_error
+template <typename T>
+class OperationTrace {
+public:
+	class const_iterator {
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = ListOperation<T>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const ListOperation<T> *;
+		using reference = const ListOperation<T> &;
+
+		//kinds from kindCount on are unknown to the version of the trace
+		const_iterator(const char * position, const char * end, size_t kindCount);
+		const ListOperation<T>& operator *() const;
+		const ListOperation<T>* operator ->() const;
+		const_iterator& operator ++();
+		bool operator ==(const const_iterator &other) const;
+		bool operator !=(const const_iterator &other) const;
+	private:
+		const char * _position; //of the operation after _op
+		const char * _end;
+		const char * _current; //of _op, _end once past the last one
+		size_t _kindCount;
+		ListOperation<T> _op;
+
+		void decode();
+		uint64_t readVarint();
+	};
+
+	//data has to outlive the trace; throws std::runtime_error if data is not a trace of T
+	//in a version this reader knows
+	OperationTrace(const char * data, size_t size);
+
+	const_iterator begin() const;
+	const_iterator end() const;
+	//number of operations, counted by decoding all of them
+	size_t count() const;
+
+	template <class List>
+	void replay(List &list) const;
+private:
+	const char * _begin;
+	const char * _end;
+	size_t _kindCount;
+};
+
+inline MappedFile::MappedFile(const std::string &path) :
+	_data(nullptr), _size(0)
+{
+#if defined(_WIN32)
+	_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER size;
+	if (_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(_file, &size))
+		throw std::runtime_error("can not open " + path);
+	_size = size_t(size.QuadPart);
+	_mapping = _size == 0 ? nullptr : CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_size != 0 && (_mapping == nullptr
+		|| (_data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0))) == nullptr)) {
+		if (_mapping != nullptr)
+			CloseHandle(_mapping);
+		CloseHandle(_file);
+		throw std::runtime_error("can not map " + path);
+	}
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	struct stat info;
+	if (fd == -1 || fstat(fd, &info) != 0) {
+		if (fd != -1)
+			close(fd);
+		throw std::runtime_error("can not open " + path);
+	}
+	_size = size_t(info.st_size);
+	if (_size != 0) {
+		void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			close(fd);
+			throw std::runtime_error("can not map " + path);
+		}
+		madvise(data, _size, MADV_SEQUENTIAL);
+		_data = static_cast<const char*>(data);
+	}
+	close(fd); //the mapping keeps the file
+#endif
+}
+
+inline MappedFile::~MappedFile()
+{
+#if defined(_WIN32)
+	if (_data != nullptr)
+		UnmapViewOfFile(_data);
+	if (_mapping != nullptr)
+		CloseHandle(_mapping);
+	CloseHandle(_file);
+#else
+	if (_data != nullptr)
+		munmap(const_cast<char*>(_data), _size);
+#endif
+}
+
+inline const char * MappedFile::data() const
+{
+	return _data;
+}
+
+inline size_t MappedFile::size() const
+{
+	return _size;
+}
+
+template<typename T>
+OperationTraceWriter<T>::OperationTraceWriter(std::ostream & out) :
+	_out(&out)
+{
+	static_assert(std::is_trivially_copyable<T>::value && sizeof(T) < 256, "T has to be stored as raw bytes");
+	_buffer.reserve(FLUSH_SIZE + 16);
+	_buffer.append(OperationTraceFormat::MAGIC, sizeof(OperationTraceFormat::MAGIC));
+	_buffer.push_back(char(OperationTraceFormat::VERSION));
+	_buffer.push_back(char(sizeof(T)));
+}
+
+template<typename T>
+OperationTraceWriter<T>::~OperationTraceWriter()
+{
+	flush();
+}
+
+template<typename T>
+void OperationTraceWriter<T>::write(const ListOperation<T> & op)
+{
+	typedef ListOperation<T> Op;
+	_buffer.push_back(char(op.kind()));
+	switch (op.kind())
+	{
+	case Op::LKinsert_at:
+		writeVarint(op.size_t_value());
+		[[fallthrough]];
+	case Op::LKpush_back:
+	case Op::LKpush_front:
+		if constexpr (std::is_integral<T>::value) {
+			int64_t value = int64_t(op.T_value());
+			writeVarint((uint64_t(value) << 1) ^ uint64_t(value >> 63)); //zigzag: small negatives stay short
+		}
+		else
+			_buffer.append(reinterpret_cast<const char*>(&op.T_value()), sizeof(T));
+		break;
+	case Op::LKget_by_iterator_from_begin:
+	case Op::LKget_by_iterator_from_end:
+	case Op::LKerase_at:
+	case Op::LKmove_to_front:
+		writeVarint(op.size_t_value());
+		break;
+	default:
+		break;
+	}
+	if (_buffer.size() >= FLUSH_SIZE)
+		flush();
+}
+
+template<typename T>
+template<class Operations>
+void OperationTraceWriter<T>::writeAll(Operations && ops)
+{
+	for (const auto &op : ops)
+		write(op);
+}
+
+template<typename T>
+void OperationTraceWriter<T>::flush()
+{
+	_out->write(_buffer.data(), _buffer.size());
+	_buffer.clear();
+}
+
+template<typename T>
+void OperationTraceWriter<T>::writeVarint(uint64_t value)
+{
+	while (value >= 0x80) {
+		_buffer.push_back(char((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	_buffer.push_back(char(value));
+}
+
+template<typename T>
+OperationTrace<T>::OperationTrace(const char * data, size_t size) :
+	_begin(data + OperationTraceFormat::HEADER_SIZE), _end(data + size), _kindCount(ListOperation<T>::KIND_COUNT)
+{
+	if (size < OperationTraceFormat::HEADER_SIZE
+		|| std::memcmp(data, OperationTraceFormat::MAGIC, sizeof(OperationTraceFormat::MAGIC)) != 0
+		|| data[sizeof(OperationTraceFormat::MAGIC) + 1] != char(sizeof(T)))
+		throw std::runtime_error("not an operation trace of this type");
+	unsigned char version = static_cast<unsigned char>(data[sizeof(OperationTraceFormat::MAGIC)]);
+	if (version < OperationTraceFormat::FIRST_VERSION || version > OperationTraceFormat::VERSION)
+		throw std::runtime_error("unknown operation trace version " + std::to_string(version));
+	if (version == 1)
+		_kindCount = ListOperation<T>::LKinsert_at;
+}
+
+template<typename T>
+typename OperationTrace<T>::const_iterator OperationTrace<T>::begin() const
+{
+	return const_iterator(_begin, _end, _kindCount);
+}
+
+template<typename T>
+typename OperationTrace<T>::const_iterator OperationTrace<T>::end() const
+{
+	return const_iterator(_end, _end, _kindCount);
+}
+
+template<typename T>
+size_t OperationTrace<T>::count() const
+{
+	size_t answer = 0;
+	for (const_iterator it = begin(); it != end(); ++it)
+		answer++;
+	return answer;
+}
+
+template<typename T>
+template<class List>
+void OperationTrace<T>::replay(List & list) const
+{
+	ListCursor<List> cursor;
+	for (const_iterator it = begin(); it != end(); ++it)
+		(*it)(list, cursor);
+}
+
+template<typename T>
+OperationTrace<T>::const_iterator::const_iterator(const char * position, const char * end, size_t kindCount) :
+	_position(position), _end(end), _current(position), _kindCount(kindCount), _op(ListOperation<T>::LKsize, 0, T())
+{
+	decode();
+}
+
+template<typename T>
+const ListOperation<T>& OperationTrace<T>::const_iterator::operator*() const
+{
+	return _op;
+}
+
+template<typename T>
+const ListOperation<T>* OperationTrace<T>::const_iterator::operator->() const
+{
+	return &_op;
+}
+
+template<typename T>
+typename OperationTrace<T>::const_iterator & OperationTrace<T>::const_iterator::operator++()
+{
+	decode();
+	return *this;
+}
+
+template<typename T>
+bool OperationTrace<T>::const_iterator::operator==(const const_iterator & other) const
+{
+	return _current == other._current;
+}
+
+template<typename T>
+bool OperationTrace<T>::const_iterator::operator!=(const const_iterator & other) const
+{
+	return _current != other._current;
+}
+
+template<typename T>
+void OperationTrace<T>::const_iterator::decode()
+{
+	typedef ListOperation<T> Op;
+	_current = _position;
+	if (_position == _end)
+		return;
+	unsigned char kindByte = static_cast<unsigned char>(*_position++);
+	if (kindByte >= _kindCount)
+		throw std::runtime_error("unknown operation kind " + std::to_string(kindByte) + " in operation trace");
+	auto kind = typename Op::Kind(kindByte);
+	size_t position = 0;
+	T value = T();
+	switch (kind)
+	{
+	case Op::LKget_by_iterator_from_begin:
+	case Op::LKget_by_iterator_from_end:
+	case Op::LKerase_at:
+	case Op::LKmove_to_front:
+		position = size_t(readVarint());
+		break;
+	case Op::LKinsert_at:
+		position = size_t(readVarint());
+		[[fallthrough]];
+	case Op::LKpush_back:
+	case Op::LKpush_front:
+		if constexpr (std::is_integral<T>::value) {
+			uint64_t zigzag = readVarint();
+			value = T(int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1));
+		}
+		else {
+			if (size_t(_end - _position) < sizeof(T))
+				throw std::runtime_error("truncated operation trace");
+			std::memcpy(&value, _position, sizeof(T));
+			_position += sizeof(T);
+		}
+		break;
+	default:
+		break;
+	}
+	_op = Op(kind, position, value);
+}
+
+template<typename T>
+uint64_t OperationTrace<T>::const_iterator::readVarint()
+{
+	uint64_t answer = 0;
+	for (size_t i = 0; i < OperationTraceFormat::MAX_VARINT_SIZE; i++) {
+		if (_position == _end)
+			throw std::runtime_error("truncated operation trace");
+		unsigned char byte = static_cast<unsigned char>(*_position++);
+		answer |= uint64_t(byte & 0x7f) << (7 * i);
+		if ((byte & 0x80) == 0)
+			return answer;
+	}
+	throw std::runtime_error("overlong varint in operation trace");
+}
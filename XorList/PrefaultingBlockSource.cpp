@@ -0,0 +1,82 @@
+#include "PrefaultingBlockSource.h"
+
+#include <algorithm>
+
+const size_t PrefaultingBlockSource::DEFAULT_DEPTH;
+
+PrefaultingBlockSource::PrefaultingBlockSource(BlockSource & upstream, size_t blockSize, size_t depth) :
+	_upstream(&upstream), _blockSize(blockSize), _depth(std::max<size_t>(depth, 1)), _stop(false)
+{
+	_ready.reserve(_depth);
+	_worker = std::thread(&PrefaultingBlockSource::work, this);
+}
+
+PrefaultingBlockSource::~PrefaultingBlockSource()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_changed.notify_all();
+	_worker.join();
+	for (char* block : _ready)
+		_upstream->release(block, _blockSize);
+}
+
+char * PrefaultingBlockSource::acquire(size_t size)
+{
+	if (size == _blockSize) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		if (!_ready.empty()) {
+			char* block = _ready.back();
+			_ready.pop_back();
+			lock.unlock();
+			_changed.notify_all(); //time to prepare the next one
+			return block;
+		}
+	}
+	return _upstream->acquire(size);
+}
+
+void PrefaultingBlockSource::release(char * const block, size_t size)
+{
+	_upstream->release(block, size);
+}
+
+void PrefaultingBlockSource::waitReady()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_changed.wait(lock, [this]() { return _ready.size() == _depth || _failure; });
+	if (_ready.size() < _depth)
+		std::rethrow_exception(_failure);
+}
+
+void PrefaultingBlockSource::work()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true) {
+		_changed.wait(lock, [this]() { return _ready.size() < _depth || _stop; });
+		if (_stop)
+			return;
+		lock.unlock();
+		char* block = nullptr;
+		std::exception_ptr failure;
+		try {
+			block = _upstream->acquire(_blockSize);
+			for (size_t offset = 0; offset < _blockSize; offset += _PAGE_SIZE)
+				block[offset] = 0;
+		}
+		catch (const std::bad_alloc&) {
+			//leave the block to the allocating thread, which will see the failure itself
+			failure = std::current_exception();
+		}
+		lock.lock();
+		if (block == nullptr) {
+			_failure = failure;
+			_changed.notify_all(); //wakes waitReady, there is nothing sensible left to do
+			return;
+		}
+		_ready.push_back(block);
+		_changed.notify_all();
+	}
+}
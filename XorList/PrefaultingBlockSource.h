@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BlockSource.h"
+
+//keeps up to depth blocks of blockSize acquired from upstream and already touched
+//by a helper thread, so that taking a new block does not page-fault on first use;
+//other sizes, and requests finding no block ready, go to upstream directly
+class PrefaultingBlockSource : public BlockSource {
+public:
+	static const size_t DEFAULT_DEPTH = 2;
+
+	//upstream has to be thread-safe and outlive this source
+	PrefaultingBlockSource(BlockSource & upstream, size_t blockSize = DEFAULT_BLOCK_SIZE,
+		size_t depth = DEFAULT_DEPTH);
+	PrefaultingBlockSource(const PrefaultingBlockSource &) = delete;
+	PrefaultingBlockSource& operator =(const PrefaultingBlockSource &) = delete;
+	~PrefaultingBlockSource();
+
+	char * acquire(size_t size) override;
+	void release(char * const block, size_t size) override;
+
+	//waits until depth blocks are ready; rethrows what the helper thread failed with
+	//(std::bad_alloc from upstream) if it stopped before that
+	void waitReady();
+private:
+	static const size_t _PAGE_SIZE = size_t(1) << 12;
+
+	BlockSource * _upstream;
+	size_t _blockSize;
+	std::vector <char*> _ready; //stack of at most depth blocks
+	size_t _depth;
+	bool _stop;
+	std::exception_ptr _failure; //set once the helper thread has given up
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	std::thread _worker;
+
+	void work();
+};
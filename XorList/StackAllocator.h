@@ -3,7 +3,11 @@
 #include <memory>
 #include <assert.h>
 
+#include "BlockSource.cpp"
 #include "BasicStackAllocator.cpp"
+#include "BlockReclaimer.cpp"
+#include "IdleTrimmer.cpp"
+#include "PrefaultingBlockSource.cpp"
 
 
 template <typename T>
@@ -22,12 +26,25 @@ public:
 	using reference = T & ;
 	using const_reference = const T &;
 
+	//containers share the arena with the list they were copied or moved from
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
 	template<class otherClass>
 	struct rebind {
 		using other = StackAllocator<otherClass>;
 	};
 
+	struct allocation_result {
+		T * ptr;
+		size_t count;
+	};
+
 	StackAllocator();
+	explicit StackAllocator(BlockSource &source, const BlockGrowthPolicy &policy = BlockGrowthPolicy());
+	//sizes the first block of the arena for expectedCount elements
+	explicit StackAllocator(size_t expectedCount);
 	StackAllocator(const StackAllocator &other);
 
 	template <typename otherClass>
@@ -35,10 +52,30 @@ public:
 	~StackAllocator();
 
 	T * allocate(size_t size);
+	//memory growing downward, picked by XorList for nodes inserted at the front,
+	//see BasicStackAllocator::allocate_front
+	T * allocate_front(size_t size);
+	allocation_result allocate_at_least(size_t size);
+	//grows or shrinks the most recent allocation in place, see BasicStackAllocator::try_extend
+	bool try_extend(T * const ptr, size_t oldSize, size_t newSize);
 	void deallocate(T * const ptr, size_t size);
 
 	size_t max_size() const;
 
+	//releases every allocation of the shared arena at once, see BasicStackAllocator::reset
+	void reset();
+	void setMaxRetainedBlocks(size_t count);
+	//releases the arena's blocks on reclaimer's thread, see BasicStackAllocator::setReclaimer
+	void setReclaimer(BlockReclaimer &reclaimer);
+	//see BasicStackAllocator::release_unused, trim and setIdleTrimmer
+	size_t release_unused();
+	size_t trim(bool lazy = false);
+	void setIdleTrimmer(IdleTrimmer &trimmer);
+
+#ifdef XORLIST_ARENA_STATS
+	const ArenaStats& stats() const;
+#endif
+
 private:
 	template <typename T1>
 	friend class StackAllocator;
@@ -57,6 +94,21 @@ StackAllocator<T>::StackAllocator()
 	_basicAlloc = std::make_shared<BasicStackAllocator>();
 }
 
+template <typename T>
+StackAllocator<T>::StackAllocator(BlockSource &source, const BlockGrowthPolicy &policy)
+{
+	_basicAlloc = std::make_shared<BasicStackAllocator>(BasicStackAllocator::UNLIMITED_RETAINED_BLOCKS, source, policy);
+}
+
+template <typename T>
+StackAllocator<T>::StackAllocator(size_t expectedCount)
+{
+	BlockGrowthPolicy policy;
+	policy.expectedBytes = expectedCount * T_SIZE;
+	_basicAlloc = std::make_shared<BasicStackAllocator>(
+		BasicStackAllocator::UNLIMITED_RETAINED_BLOCKS, BlockSource::defaultSource(), policy);
+}
+
 template <typename T>
 StackAllocator<T>::StackAllocator(const StackAllocator &other) :
 	_basicAlloc(other._basicAlloc)
@@ -81,7 +133,26 @@ StackAllocator<T>::~StackAllocator()
 template <typename T>
 T * StackAllocator<T>::allocate(size_t size)
 {
-	return reinterpret_cast <T*> (_basicAlloc->allocate(size * T_SIZE));
+	return reinterpret_cast <T*> (_basicAlloc->allocate(size * T_SIZE, alignof(T)));
+}
+
+template <typename T>
+T * StackAllocator<T>::allocate_front(size_t size)
+{
+	return reinterpret_cast <T*> (_basicAlloc->allocate_front(size * T_SIZE, alignof(T)));
+}
+
+template <typename T>
+typename StackAllocator<T>::allocation_result StackAllocator<T>::allocate_at_least(size_t size)
+{
+	BasicStackAllocator::AllocationResult result = _basicAlloc->allocate_at_least(size * T_SIZE, alignof(T));
+	return allocation_result{ reinterpret_cast <T*> (result.ptr), result.size / T_SIZE };
+}
+
+template <typename T>
+bool StackAllocator<T>::try_extend(T * const ptr, size_t oldSize, size_t newSize)
+{
+	return _basicAlloc->try_extend(reinterpret_cast <char*> (ptr), oldSize * T_SIZE, newSize * T_SIZE);
 }
 
 template <typename T>
@@ -96,6 +167,50 @@ size_t StackAllocator<T>::max_size() const
 	return _basicAlloc->max_size() / T_SIZE;
 }
 
+template<typename T>
+void StackAllocator<T>::reset()
+{
+	_basicAlloc->reset();
+}
+
+template<typename T>
+void StackAllocator<T>::setMaxRetainedBlocks(size_t count)
+{
+	_basicAlloc->setMaxRetainedBlocks(count);
+}
+
+template<typename T>
+void StackAllocator<T>::setReclaimer(BlockReclaimer &reclaimer)
+{
+	_basicAlloc->setReclaimer(&reclaimer);
+}
+
+template<typename T>
+size_t StackAllocator<T>::release_unused()
+{
+	return _basicAlloc->release_unused();
+}
+
+template<typename T>
+size_t StackAllocator<T>::trim(bool lazy)
+{
+	return _basicAlloc->trim(lazy);
+}
+
+template<typename T>
+void StackAllocator<T>::setIdleTrimmer(IdleTrimmer &trimmer)
+{
+	_basicAlloc->setIdleTrimmer(&trimmer);
+}
+
+#ifdef XORLIST_ARENA_STATS
+template<typename T>
+const ArenaStats& StackAllocator<T>::stats() const
+{
+	return _basicAlloc->stats();
+}
+#endif
+
 template <typename T1, typename T2>
 bool operator==(const StackAllocator<T1>& lhs, const StackAllocator<T2>& rhs)
 {
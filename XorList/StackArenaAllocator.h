@@ -0,0 +1,159 @@
+#pragma once
+
+#include "StackAllocator.h"
+
+//explicit owner of an arena for StackArenaAllocator handles;
+//has to outlive every container allocating from it
+class StackArena {
+public:
+	explicit StackArena(BlockSource &source = BlockSource::defaultSource(),
+		const BlockGrowthPolicy &policy = BlockGrowthPolicy());
+	StackArena(const StackArena &) = delete;
+	StackArena& operator =(const StackArena &) = delete;
+
+	void reset();
+	void setReclaimer(BlockReclaimer &reclaimer);
+	BasicStackAllocator& basicAllocator();
+private:
+	BasicStackAllocator _basicAlloc;
+};
+
+template <typename T>
+class StackArenaAllocator;
+
+template <typename T1, typename T2>
+bool operator==(const StackArenaAllocator<T1>& lhs, const StackArenaAllocator<T2>& rhs);
+
+//StackAllocator without the shared ownership: a plain pointer to a StackArena,
+//so copies and rebinds touch no reference counter
+template <typename T>
+class StackArenaAllocator {
+public:
+	using value_type = T;
+	using pointer = T * ;
+	using const_pointer = const T *;
+	using reference = T & ;
+	using const_reference = const T &;
+
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	template<class otherClass>
+	struct rebind {
+		using other = StackArenaAllocator<otherClass>;
+	};
+
+	struct allocation_result {
+		T * ptr;
+		size_t count;
+	};
+
+	StackArenaAllocator(StackArena &arena);
+	StackArenaAllocator(const StackArenaAllocator &other) = default;
+
+	template <typename otherClass>
+	StackArenaAllocator(const StackArenaAllocator <otherClass> &other);
+
+	T * allocate(size_t size);
+	T * allocate_front(size_t size);
+	allocation_result allocate_at_least(size_t size);
+	bool try_extend(T * const ptr, size_t oldSize, size_t newSize);
+	void deallocate(T * const ptr, size_t size);
+
+	size_t max_size() const;
+
+private:
+	template <typename T1>
+	friend class StackArenaAllocator;
+
+	template <typename T1, typename T2>
+	friend bool operator==(const StackArenaAllocator<T1>& lhs, const StackArenaAllocator<T2>& rhs);
+
+	BasicStackAllocator * _basicAlloc;
+};
+
+inline StackArena::StackArena(BlockSource &source, const BlockGrowthPolicy &policy) :
+	_basicAlloc(BasicStackAllocator::UNLIMITED_RETAINED_BLOCKS, source, policy)
+{
+	//initialize values
+}
+
+inline void StackArena::reset()
+{
+	_basicAlloc.reset();
+}
+
+inline void StackArena::setReclaimer(BlockReclaimer &reclaimer)
+{
+	_basicAlloc.setReclaimer(&reclaimer);
+}
+
+inline BasicStackAllocator& StackArena::basicAllocator()
+{
+	return _basicAlloc;
+}
+
+template <typename T>
+StackArenaAllocator<T>::StackArenaAllocator(StackArena &arena) :
+	_basicAlloc(&arena.basicAllocator())
+{
+	//initialize values
+}
+
+template <typename T>
+template <typename otherClass>
+StackArenaAllocator<T>::StackArenaAllocator(const StackArenaAllocator <otherClass> &other) :
+	_basicAlloc(other._basicAlloc)
+{
+	//initialize values
+}
+
+template <typename T>
+T * StackArenaAllocator<T>::allocate(size_t size)
+{
+	return reinterpret_cast <T*> (_basicAlloc->allocate(size * sizeof(T), alignof(T)));
+}
+
+template <typename T>
+T * StackArenaAllocator<T>::allocate_front(size_t size)
+{
+	return reinterpret_cast <T*> (_basicAlloc->allocate_front(size * sizeof(T), alignof(T)));
+}
+
+template <typename T>
+typename StackArenaAllocator<T>::allocation_result StackArenaAllocator<T>::allocate_at_least(size_t size)
+{
+	BasicStackAllocator::AllocationResult result = _basicAlloc->allocate_at_least(size * sizeof(T), alignof(T));
+	return allocation_result{ reinterpret_cast <T*> (result.ptr), result.size / sizeof(T) };
+}
+
+template <typename T>
+bool StackArenaAllocator<T>::try_extend(T * const ptr, size_t oldSize, size_t newSize)
+{
+	return _basicAlloc->try_extend(reinterpret_cast <char*> (ptr), oldSize * sizeof(T), newSize * sizeof(T));
+}
+
+template <typename T>
+void StackArenaAllocator<T>::deallocate(T * const ptr, size_t size)
+{
+	//do nothing
+}
+
+template<typename T>
+size_t StackArenaAllocator<T>::max_size() const
+{
+	return _basicAlloc->max_size() / sizeof(T);
+}
+
+template <typename T1, typename T2>
+bool operator==(const StackArenaAllocator<T1>& lhs, const StackArenaAllocator<T2>& rhs)
+{
+	return lhs._basicAlloc == rhs._basicAlloc;
+}
+
+template <typename T1, typename T2>
+bool operator!=(const StackArenaAllocator<T1>& lhs, const StackArenaAllocator<T2>& rhs)
+{
+	return !(lhs == rhs);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <memory_resource>
+
+#include "StackAllocator.h"
+
+//std::pmr view of a stack arena: everything allocated through it, including
+//the memory of pmr containers nested in the elements, is freed at once
+class StackMemoryResource : public std::pmr::memory_resource {
+public:
+	explicit StackMemoryResource(BlockSource &source = BlockSource::defaultSource(),
+		const BlockGrowthPolicy &policy = BlockGrowthPolicy());
+	StackMemoryResource(const StackMemoryResource &) = delete;
+	StackMemoryResource& operator =(const StackMemoryResource &) = delete;
+
+	void reset();
+private:
+	void * do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void * ptr, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+	BasicStackAllocator _basicAlloc;
+};
+
+inline StackMemoryResource::StackMemoryResource(BlockSource &source, const BlockGrowthPolicy &policy) :
+	_basicAlloc(BasicStackAllocator::UNLIMITED_RETAINED_BLOCKS, source, policy)
+{
+	//initialize values
+}
+
+inline void StackMemoryResource::reset()
+{
+	_basicAlloc.reset();
+}
+
+inline void * StackMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+	return _basicAlloc.allocate(bytes, alignment);
+}
+
+inline void StackMemoryResource::do_deallocate(void * ptr, size_t bytes, size_t alignment)
+{
+	//do nothing
+}
+
+inline bool StackMemoryResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+	return this == &other;
+}
@@ -0,0 +1,411 @@
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "XorList.h"
+#include "OperationTrace.h"
+
+//hands every sampleEvery-th list a trace file of its own, pathPrefix + number + ".xlot",
+//so that the lists of a program can be recorded without paying for all of them
+class TraceSampler {
+public:
+	explicit TraceSampler(const std::string &pathPrefix, size_t sampleEvery = 1);
+	TraceSampler(const TraceSampler &) = delete;
+	TraceSampler& operator =(const TraceSampler &) = delete;
+
+	//file for the next list, nullptr if that one is not sampled; throws std::runtime_error
+	//if the file can not be created
+	std::unique_ptr<std::ofstream> next();
+private:
+	std::string _pathPrefix;
+	size_t _sampleEvery;
+	std::atomic<size_t> _lists;
+};
+
+//forwards to Inner and appends every call to a trace, so that OperationTrace can replay them: size,
+//back, front, push_* and pop_* as themselves, a read through an iterator as get_by_iterator_from_begin,
+//insert_* as insert_at and erase as erase_at, at the position of the iterator. Its iterators count
+//their position as they move and give read-only access, since the trace has no kind for a write.
+//They stay valid as long as the ones of Inner do: for XorList, a change next to the element of an
+//iterator invalidates it, and a traced list throws std::logic_error when it meets such an iterator
+//again after more than one change. A sampled-out list forwards only and costs a null test per
+//call. Inner has to start empty for the replay to reproduce it
+template <class T, class Inner = XorList<T>>
+class TracingXorList {
+public:
+	class iterator {
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const T *;
+		using reference = const T &;
+
+		iterator() = default;
+		iterator& operator ++();
+		iterator operator ++(int);
+		iterator& operator --();
+		iterator operator --(int);
+		//recorded as a read at the position of the iterator
+		const T& operator *() const;
+		bool operator ==(const iterator &other) const;
+		bool operator !=(const iterator &other) const;
+	private:
+		friend class TracingXorList;
+
+		typename Inner::iterator _it;
+		const TracingXorList * _list = nullptr;
+		//counted from begin() as of the change _version of _list, only kept if _list is traced
+		mutable size_t _position = 0;
+		mutable size_t _version = 0;
+
+		iterator(const TracingXorList * list, typename Inner::iterator it, size_t position);
+		//brings _position up to date with the changes _list has seen since _version
+		size_t position() const;
+	};
+
+	explicit TracingXorList(std::ostream &out, Inner inner = Inner());
+	explicit TracingXorList(TraceSampler &sampler, Inner inner = Inner());
+	TracingXorList(const TracingXorList &) = delete;
+	TracingXorList& operator =(const TracingXorList &) = delete;
+
+	bool traced() const;
+	//writes the buffered operations out, which otherwise happens every
+	//OperationTraceWriter<T>::FLUSH_SIZE bytes and on destruction
+	void flush();
+	const Inner& inner() const;
+
+	size_t size() const;
+	bool empty() const;
+
+	T back() const;
+	T& back();
+	T front() const;
+	T& front();
+
+	template <typename T1>
+	void push_back(T1&&);
+	template <typename T1>
+	void push_front(T1&&);
+
+	void pop_back();
+	void pop_front();
+
+	template <typename T1>
+	void insert_before(iterator, T1&&);
+	template <typename T1>
+	void insert_after(iterator, T1&&);
+	void erase(iterator);
+
+	iterator begin() const;
+	iterator end() const;
+private:
+	typedef ListOperation<T> _Operation;
+
+	Inner _inner;
+	std::unique_ptr<std::ofstream> _file; //of a sampler, has to outlive _writer
+	std::unique_ptr<OperationTraceWriter<T>> _writer; //nullptr if not traced
+	//counts the changes of a traced list; an iterator one change behind follows the last one,
+	//one further behind finds its position again by walking from begin()
+	size_t _version;
+	size_t _lastChangePosition;
+	bool _lastChangeInserted;
+
+	void record(typename _Operation::Kind kind, size_t position = 0, const T &value = T()) const;
+	void changed(size_t position, bool inserted);
+};
+
+inline TraceSampler::TraceSampler(const std::string &pathPrefix, size_t sampleEvery) :
+	_pathPrefix(pathPrefix), _sampleEvery(sampleEvery == 0 ? 1 : sampleEvery), _lists(0)
+{
+	//initialize values
+}
+
+inline std::unique_ptr<std::ofstream> TraceSampler::next()
+{
+	size_t list = _lists.fetch_add(1, std::memory_order_relaxed);
+	if (list % _sampleEvery != 0)
+		return nullptr;
+	std::string path = _pathPrefix + std::to_string(list) + ".xlot";
+	std::unique_ptr<std::ofstream> answer(new std::ofstream(path, std::ios::binary));
+	if (!*answer)
+		throw std::runtime_error("can not create " + path);
+	return answer;
+}
+
+template<class T, class Inner>
+TracingXorList<T, Inner>::TracingXorList(std::ostream & out, Inner inner) :
+	_inner(std::move(inner)), _writer(new OperationTraceWriter<T>(out)),
+	_version(0), _lastChangePosition(0), _lastChangeInserted(false)
+{
+	//initialize values
+}
+
+template<class T, class Inner>
+TracingXorList<T, Inner>::TracingXorList(TraceSampler & sampler, Inner inner) :
+	_inner(std::move(inner)), _file(sampler.next()),
+	_version(0), _lastChangePosition(0), _lastChangeInserted(false)
+{
+	if (_file)
+		_writer.reset(new OperationTraceWriter<T>(*_file));
+}
+
+template<class T, class Inner>
+bool TracingXorList<T, Inner>::traced() const
+{
+	return _writer != nullptr;
+}
+
+template<class T, class Inner>
+void TracingXorList<T, Inner>::flush()
+{
+	if (_writer) {
+		_writer->flush();
+		if (_file)
+			_file->flush();
+	}
+}
+
+template<class T, class Inner>
+const Inner & TracingXorList<T, Inner>::inner() const
+{
+	return _inner;
+}
+
+template<class T, class Inner>
+size_t TracingXorList<T, Inner>::size() const
+{
+	record(_Operation::LKsize);
+	return _inner.size();
+}
+
+template<class T, class Inner>
+bool TracingXorList<T, Inner>::empty() const
+{
+	return _inner.empty();
+}
+
+template<class T, class Inner>
+T TracingXorList<T, Inner>::back() const
+{
+	record(_Operation::LKback);
+	return _inner.back();
+}
+
+template<class T, class Inner>
+T & TracingXorList<T, Inner>::back()
+{
+	record(_Operation::LKback);
+	return _inner.back();
+}
+
+template<class T, class Inner>
+T TracingXorList<T, Inner>::front() const
+{
+	record(_Operation::LKfront);
+	return _inner.front();
+}
+
+template<class T, class Inner>
+T & TracingXorList<T, Inner>::front()
+{
+	record(_Operation::LKfront);
+	return _inner.front();
+}
+
+template<class T, class Inner>
+template<typename T1>
+void TracingXorList<T, Inner>::push_back(T1 && value)
+{
+	if (_writer) {
+		record(_Operation::LKpush_back, 0, value);
+		changed(_inner.size(), true);
+	}
+	_inner.push_back(std::forward<T1>(value));
+}
+
+template<class T, class Inner>
+template<typename T1>
+void TracingXorList<T, Inner>::push_front(T1 && value)
+{
+	if (_writer) {
+		record(_Operation::LKpush_front, 0, value);
+		changed(0, true);
+	}
+	_inner.push_front(std::forward<T1>(value));
+}
+
+template<class T, class Inner>
+void TracingXorList<T, Inner>::pop_back()
+{
+	if (_writer) {
+		record(_Operation::LKpop_back);
+		changed(_inner.size() - 1, false);
+	}
+	_inner.pop_back();
+}
+
+template<class T, class Inner>
+void TracingXorList<T, Inner>::pop_front()
+{
+	if (_writer) {
+		record(_Operation::LKpop_front);
+		changed(0, false);
+	}
+	_inner.pop_front();
+}
+
+template<class T, class Inner>
+template<typename T1>
+void TracingXorList<T, Inner>::insert_before(iterator it, T1 && value)
+{
+	if (_writer) {
+		size_t position = it.position();
+		record(_Operation::LKinsert_at, position, value);
+		changed(position, true);
+	}
+	_inner.insert_before(it._it, std::forward<T1>(value));
+}
+
+template<class T, class Inner>
+template<typename T1>
+void TracingXorList<T, Inner>::insert_after(iterator it, T1 && value)
+{
+	if (_writer) {
+		size_t position = it.position() + 1;
+		record(_Operation::LKinsert_at, position, value);
+		changed(position, true);
+	}
+	_inner.insert_after(it._it, std::forward<T1>(value));
+}
+
+template<class T, class Inner>
+void TracingXorList<T, Inner>::erase(iterator it)
+{
+	if (_writer) {
+		size_t position = it.position();
+		record(_Operation::LKerase_at, position);
+		changed(position, false);
+	}
+	_inner.erase(it._it);
+}
+
+template<class T, class Inner>
+typename TracingXorList<T, Inner>::iterator TracingXorList<T, Inner>::begin() const
+{
+	return iterator(this, _inner.begin(), 0);
+}
+
+template<class T, class Inner>
+typename TracingXorList<T, Inner>::iterator TracingXorList<T, Inner>::end() const
+{
+	return iterator(this, _inner.end(), _inner.size());
+}
+
+template<class T, class Inner>
+void TracingXorList<T, Inner>::record(typename _Operation::Kind kind, size_t position, const T & value) const
+{
+	if (_writer)
+		_writer->write(_Operation(kind, position, value));
+}
+
+template<class T, class Inner>
+void TracingXorList<T, Inner>::changed(size_t position, bool inserted)
+{
+	_version++;
+	_lastChangePosition = position;
+	_lastChangeInserted = inserted;
+}
+
+template<class T, class Inner>
+TracingXorList<T, Inner>::iterator::iterator(const TracingXorList * list, typename Inner::iterator it, size_t position) :
+	_it(it), _list(list), _position(position), _version(list->_version)
+{
+	//initialize values
+}
+
+template<class T, class Inner>
+typename TracingXorList<T, Inner>::iterator & TracingXorList<T, Inner>::iterator::operator++()
+{
+	if (_list->_writer) {
+		position();
+		_position++;
+	}
+	++_it;
+	return *this;
+}
+
+template<class T, class Inner>
+typename TracingXorList<T, Inner>::iterator TracingXorList<T, Inner>::iterator::operator++(int)
+{
+	iterator old = *this;
+	++*this;
+	return old;
+}
+
+template<class T, class Inner>
+typename TracingXorList<T, Inner>::iterator & TracingXorList<T, Inner>::iterator::operator--()
+{
+	if (_list->_writer) {
+		position();
+		_position--;
+	}
+	--_it;
+	return *this;
+}
+
+template<class T, class Inner>
+typename TracingXorList<T, Inner>::iterator TracingXorList<T, Inner>::iterator::operator--(int)
+{
+	iterator old = *this;
+	--*this;
+	return old;
+}
+
+template<class T, class Inner>
+const T & TracingXorList<T, Inner>::iterator::operator*() const
+{
+	if (_list->_writer)
+		_list->record(_Operation::LKget_by_iterator_from_begin, position());
+	typename Inner::iterator it = _it;
+	return *it;
+}
+
+template<class T, class Inner>
+bool TracingXorList<T, Inner>::iterator::operator==(const iterator & other) const
+{
+	return _it == other._it;
+}
+
+template<class T, class Inner>
+bool TracingXorList<T, Inner>::iterator::operator!=(const iterator & other) const
+{
+	return _it != other._it;
+}
+
+template<class T, class Inner>
+size_t TracingXorList<T, Inner>::iterator::position() const
+{
+	if (_version + 1 == _list->_version) {
+		if (_list->_lastChangeInserted && _position >= _list->_lastChangePosition)
+			_position++;
+		else if (!_list->_lastChangeInserted && _position > _list->_lastChangePosition)
+			_position--;
+	}
+	else if (_version != _list->_version) {
+		_position = 0;
+		typename Inner::iterator it = _list->_inner.begin(), end = _list->_inner.end();
+		for (; it != _it && it != end; ++it)
+			_position++;
+		if (it != _it)
+			throw std::logic_error("TracingXorList iterator invalidated by a change of the list");
+	}
+	_version = _list->_version;
+	return _position;
+}
@@ -2,10 +2,21 @@
 #include <assert.h>
 #include <iterator>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
 
 template <typename T>
 struct errorType;
 
+//allocators with allocate_front(n) get it for nodes inserted before the first one
+template <class Alloc, class = void>
+struct hasAllocateFront : std::false_type {};
+
+template <class Alloc>
+struct hasAllocateFront<Alloc, std::void_t<decltype(std::declval<Alloc&>().allocate_front(size_t(1)))>> : std::true_type {};
+
 template <class T, class Allocator = std::allocator<T>>
 class XorList {
 public:
@@ -20,6 +31,8 @@ public:
 
 	bool operator ==(const XorList &other) const;
 
+	Allocator get_allocator() const;
+
 	size_t size() const;
 	bool empty() const;
 
@@ -40,8 +53,14 @@ private:
 	struct _Node;
 	typedef _Node* _pNode;
 public:
-	class iterator : public std::iterator <std::bidirectional_iterator_tag, T> {
+	class iterator {
 	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = T * ;
+		using reference = T & ;
+
 		iterator() = default;
 		iterator(const iterator & other) = default;
 		iterator(_pNode prevNode, _pNode pNode);
@@ -86,11 +105,12 @@ private:
 	template <typename T1>
 	void insert_between(_pNode first, _pNode second, T1&& value);
 
-	_pNode create(T&&);
-	_pNode create(const T&);
+	template <typename T1>
+	_pNode create(T1&&, bool atFront = false);
 	void free(_pNode);
 
-	using _XorListAllocator = typename Allocator::template rebind<_Node>::other;
+	using _XorListAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<_Node>;
+	using _XorListAllocatorTraits = std::allocator_traits<_XorListAllocator>;
 	_XorListAllocator _xorListAlloc;
 
 	_pNode _begin, _end;
@@ -104,18 +124,17 @@ XorList<T, Allocator>::XorList(const Allocator& alloc) : _size(0), _xorListAlloc
 }
 
 template<class T, class Allocator>
-XorList<T, Allocator>::XorList(const XorList<T, Allocator> & other) : _size(0)
+XorList<T, Allocator>::XorList(const XorList<T, Allocator> & other) :
+	_xorListAlloc(_XorListAllocatorTraits::select_on_container_copy_construction(other._xorListAlloc)), _size(0)
 {
-	_xorListAlloc = std::allocator_traits<_XorListAllocator>::select_on_container_copy_construction(other._xorListAlloc);
 	_begin = _end = nullptr;
 	copy_elements(other);
 }
 
 template<class T, class Allocator>
 XorList<T, Allocator>::XorList(XorList<T, Allocator> && other) :
-	_size(other._size), _begin(other._begin), _end(other._end)
+	_xorListAlloc(std::move(other._xorListAlloc)), _begin(other._begin), _end(other._end), _size(other._size)
 {
-	_xorListAlloc = std::move<_XorListAllocator>(other._xorListAlloc);
 	other._begin = other._end = nullptr;
 	other._size = 0;
 }
@@ -129,8 +148,11 @@ XorList<T, Allocator>::~XorList()
 template<class T, class Allocator>
 XorList<T, Allocator> & XorList<T, Allocator>::operator=(const XorList<T, Allocator> & other)
 {
-	_xorListAlloc = std::allocator_traits<_XorListAllocator>::select_on_container_copy_construction(other._xorListAlloc);
-	_size = 0;
+	if (this == &other)
+		return *this;
+	free_elements();
+	if constexpr (_XorListAllocatorTraits::propagate_on_container_copy_assignment::value)
+		_xorListAlloc = other._xorListAlloc;
 	copy_elements(other);
 	return *this;
 }
@@ -138,7 +160,18 @@ XorList<T, Allocator> & XorList<T, Allocator>::operator=(const XorList<T, Alloca
 template<class T, class Allocator>
 XorList<T, Allocator> & XorList<T, Allocator>::operator=(XorList<T, Allocator> && other)
 {
-	_xorListAlloc = std::move<_XorListAllocator>(other._xorListAlloc);
+	if (this == &other)
+		return *this;
+	free_elements();
+	if constexpr (_XorListAllocatorTraits::propagate_on_container_move_assignment::value)
+		_xorListAlloc = std::move(other._xorListAlloc);
+	else if (!(_xorListAlloc == other._xorListAlloc)) {
+		//nodes of other can not be freed by our allocator, so move the elements one by one
+		for (iterator it = other.begin(); it != other.end(); ++it)
+			push_back(std::move(*it));
+		other.free_elements();
+		return *this;
+	}
 	_begin = other._begin;
 	_end = other._end;
 	_size = other._size;
@@ -148,7 +181,7 @@ XorList<T, Allocator> & XorList<T, Allocator>::operator=(XorList<T, Allocator> &
 }
 
 template<class T, class Allocator>
-XorList<T, Allocator>::XorList(size_t count, const T & value, const Allocator & alloc):_xorListAlloc(alloc)
+XorList<T, Allocator>::XorList(size_t count, const T & value, const Allocator & alloc) : _size(0), _xorListAlloc(alloc)
 {
 	_begin = _end = nullptr;
 	for (size_t i = 0; i < count; i++)
@@ -263,6 +296,12 @@ void XorList<T, Allocator>::erase(iterator it)
 	free(delNode);
 }
 
+template<class T, class Allocator>
+Allocator XorList<T, Allocator>::get_allocator() const
+{
+	return Allocator(_xorListAlloc);
+}
+
 template<class T, class Allocator>
 typename XorList<T, Allocator>::iterator XorList<T, Allocator>::begin() const
 {
@@ -305,7 +344,7 @@ template<class T, class Allocator>
 template<typename T1>
 void XorList<T, Allocator>::insert_between(_pNode first, _pNode second, T1 && value)
 {
-	_pNode newNode = create(std::forward<T1>(value));
+	_pNode newNode = create(std::forward<T1>(value), first == nullptr && second != nullptr);
 	_size++;
 	if (first != nullptr)
 		update(first, previous(first, second), newNode);
@@ -319,25 +358,30 @@ void XorList<T, Allocator>::insert_between(_pNode first, _pNode second, T1 && va
 }
 
 template<class T, class Allocator>
-typename XorList<T, Allocator>::_pNode XorList<T, Allocator>::create(T && value)
-{
-	auto ptr = new(_xorListAlloc.allocate(1)) _Node;
-	ptr->_key = std::move(std::forward<T>(value));
-	return ptr;
-}
-
-template<class T, class Allocator>
-typename XorList<T, Allocator>::_pNode XorList<T, Allocator>::create(const T & value)
+template<typename T1>
+typename XorList<T, Allocator>::_pNode XorList<T, Allocator>::create(T1 && value, bool atFront)
 {
-	auto ptr = new(_xorListAlloc.allocate(1)) _Node;
-	ptr->_key = value;
+	_pNode ptr;
+	if constexpr (hasAllocateFront<_XorListAllocator>::value)
+		ptr = atFront ? _xorListAlloc.allocate_front(1) : _XorListAllocatorTraits::allocate(_xorListAlloc, 1);
+	else
+		ptr = _XorListAllocatorTraits::allocate(_xorListAlloc, 1);
+	try {
+		//constructing through the allocator lets scoped allocators (std::pmr) reach the key
+		_XorListAllocatorTraits::construct(_xorListAlloc, std::addressof(ptr->_key), std::forward<T1>(value));
+	}
+	catch (...) {
+		_XorListAllocatorTraits::deallocate(_xorListAlloc, ptr, 1);
+		throw;
+	}
 	return ptr;
 }
 
 template<class T, class Allocator>
 void XorList<T, Allocator>::free(_pNode pnode)
 {
-	_xorListAlloc.deallocate(pnode, 1);
+	_XorListAllocatorTraits::destroy(_xorListAlloc, std::addressof(pnode->_key));
+	_XorListAllocatorTraits::deallocate(_xorListAlloc, pnode, 1);
 }
 
 template<class T, class Allocator>
@@ -406,4 +450,9 @@ template<class T, class Allocator>
 void XorList<T, Allocator>::update(_pNode node, _pNode previous, _pNode next)
 {
 	node->_prevXorNext = IntPtr(previous) ^ IntPtr(next);
-}
\ No newline at end of file
+}
+
+namespace pmr {
+	template <class T>
+	using XorList = ::XorList<T, std::pmr::polymorphic_allocator<T> >;
+}